@@ -0,0 +1,52 @@
+// Per-event cost of the achievement engine with few and with many
+// achievement definitions. The cost should not grow with the definition count.
+//
+//   achievement_bench [definitions]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/achievements.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double nsPerEvent(int definitions) {
+    const int fruitTypes = 4;
+    AchievementEngine engine;
+    unsigned seed = 12345;
+    for (int i = 0; i < definitions; i++) {
+        seed = seed * 1103515245 + 12345;
+        AchievementTrigger trigger = static_cast<AchievementTrigger>(seed % 5);
+        engine.define({"achievement", trigger, static_cast<std::int64_t>(seed % 2000000),
+                       static_cast<int>((seed >> 8) % fruitTypes)});
+    }
+
+    const int events = 10000000;
+    std::int64_t score = 0;
+    std::size_t unlocked = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < events; i++) {
+        seed = seed * 1103515245 + 12345;
+        if (seed % 8 == 0) {
+            engine.onMiss();
+            score -= 5;
+        } else {
+            engine.onCatch((seed >> 8) % fruitTypes);
+            score += 10;
+        }
+        engine.onScore(score);
+        unlocked += engine.newlyUnlocked().size();
+        engine.clearNewlyUnlocked();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / events;
+    std::printf("%6d definitions: %6.2f ns/event, %zu unlocked\n", definitions, ns, unlocked);
+    return ns;
+}
+
+int main(int argc, char** argv) {
+    int definitions = argc > 1 ? std::atoi(argv[1]) : 10000;
+    nsPerEvent(10);
+    nsPerEvent(definitions);
+    return 0;
+}
@@ -0,0 +1,279 @@
+// Frames over a congested link: the game loop at 60 frames per second on a
+// 20 Hz simulation, drawing braille frames into a pipe whose reader takes
+// 256 bytes once a second, like a stalled SSH connection, and starts with
+// the pipe nearly full. After the congested stretch the link drains and
+// the loop goes on for a second. Played once with blocking writes, as
+// through std::cout, and once through FrameWriter. Reports ticks simulated
+// against the wall clock, the longest frame, and frames dropped and sent
+// per second. Fails if with FrameWriter the simulation falls behind, a
+// frame takes longer than the frame interval, no frame is dropped while
+// congested or one still is after the link drained, if the screen the
+// reader rebuilds from the stream is not the last frame drawn, or if the
+// descriptor handed to FrameWriter, shared with stdin and stderr in the
+// game, was made non-blocking.
+//
+//   backpressure_bench [congested seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../src/frame_diff.h"
+#include "../src/frame_writer.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+const int HEADER_ROWS = 1;
+const int TICK_MS = 50;
+const int FPS = 60;
+const int PIPE_BYTES = 4096;
+const int BURST_BYTES = 256;
+const auto BURST_INTERVAL = std::chrono::seconds(1);
+const auto DRAINED_TIME = std::chrono::seconds(1);
+// Frames may still be dropped while the last ones left go out
+const auto SETTLE_TIME = std::chrono::milliseconds(250);
+const auto MAX_FRAME_TIME = std::chrono::milliseconds(250);
+
+// The reading end of the pipe: bursts until drainAt, everything after.
+// Keeps its own time, since a blocked writer cannot tell it anything.
+class Link {
+public:
+    Link(int fd, Clock::time_point drainAt) : fd(fd), drainAt(drainAt), reader([this] { readLoop(); }) {}
+
+    // Everything read, once the writing end is closed
+    const std::string& finish() {
+        reader.join();
+        return stream;
+    }
+
+private:
+    int fd;
+    Clock::time_point drainAt;
+    std::string stream;
+    std::thread reader;
+
+    void readLoop() {
+        char buffer[PIPE_BYTES];
+        Clock::time_point burstAt = Clock::now() + BURST_INTERVAL;
+        for (;;) {
+            bool drained = Clock::now() >= drainAt;
+            if (!drained && Clock::now() < burstAt) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            ssize_t count = read(fd, buffer, drained ? sizeof(buffer) : BURST_BYTES);
+            if (count <= 0) return;
+            stream.append(buffer, count);
+            burstAt += BURST_INTERVAL;
+        }
+    }
+};
+
+// Rebuilds the screen from the stream as a terminal would, for what frames
+// contain: cursor position, erase in line and below, styles and modes
+// (ignored) and UTF-8 text
+static std::vector<char32_t> rebuildScreen(const std::string& stream, int width, int height) {
+    std::vector<char32_t> grid(static_cast<std::size_t>(width) * height, U' ');
+    int row = 0;
+    int column = 0;
+    auto erase = [&](int fromRow, int fromColumn, int toRow) {
+        for (int y = fromRow; y < std::min(toRow, height); y++) {
+            for (int x = y == fromRow ? fromColumn : 0; x < width; x++) grid[y * width + x] = U' ';
+        }
+    };
+    for (std::size_t i = 0; i < stream.size();) {
+        unsigned char byte = stream[i];
+        if (byte == '\x1b' && i + 1 < stream.size() && stream[i + 1] == '[') {
+            std::size_t end = i + 2;
+            while (end < stream.size() && (stream[end] < 0x40 || stream[end] > 0x7e)) end++;
+            std::string parameters = stream.substr(i + 2, end - i - 2);
+            char command = end < stream.size() ? stream[end] : 0;
+            if (command == 'H') {
+                int r = 1;
+                int c = 1;
+                std::sscanf(parameters.c_str(), "%d;%d", &r, &c);
+                row = r - 1;
+                column = c - 1;
+            } else if (command == 'K') {
+                erase(row, column, row + 1);
+            } else if (command == 'J') {
+                erase(row, column, height);
+            }
+            i = end + 1;
+        } else if (byte == '\n') {
+            row++;
+            column = 0;
+            i++;
+        } else if (byte == '\r') {
+            column = 0;
+            i++;
+        } else {
+            char32_t glyph = byte;
+            int length = 1;
+            if (byte >= 0xf0) {
+                glyph = byte & 0x07;
+                length = 4;
+            } else if (byte >= 0xe0) {
+                glyph = byte & 0x0f;
+                length = 3;
+            } else if (byte >= 0xc0) {
+                glyph = byte & 0x1f;
+                length = 2;
+            }
+            for (int k = 1; k < length && i + k < stream.size(); k++) glyph = glyph << 6 | (stream[i + k] & 0x3f);
+            if (row < height && column < width) grid[row * width + column] = glyph;
+            column++;
+            i += length;
+        }
+    }
+    return grid;
+}
+
+struct LinkRun {
+    long ticks;
+    long expectedTicks;         // from the wall clock over the same time
+    double maxFrameMs;
+    long frames;
+    long sent;
+    long dropped;
+    long droppedAfterDrain;     // once the link had settled
+    bool screenMatches;
+    bool stayedBlocking;        // the descriptor given to FrameWriter
+};
+
+static LinkRun play(bool nonBlocking, double congestedSeconds) {
+    LinkRun run{0, 0, 0, 0, 0, 0, 0, false, false};
+    int fds[2];
+    if (pipe(fds) != 0) return run;
+    fcntl(fds[1], F_SETPIPE_SZ, PIPE_BYTES);
+    // Left over from before the link stalled
+    std::string backlog;
+    while (backlog.size() + 4 < PIPE_BYTES - 512) backlog += "\x1b[0m";
+    if (write(fds[1], backlog.data(), backlog.size()) < 0) return run;
+    Clock::time_point start = Clock::now();
+    Clock::time_point drainAt = start + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double>(congestedSeconds));
+    Link link(fds[0], drainAt);
+
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Simulation sim(fruits, SimulationConfig{WIDTH, HEIGHT, TICK_MS, TICK_MS, 0, {}}, 7);
+    Theme theme = Theme::dark();
+    int screenHeight = HEADER_ROWS + HEIGHT + 2;
+    Framebuffer screen(WIDTH, screenHeight);
+    Framebuffer shown(WIDTH, screenHeight);
+    std::vector<Span> spans;
+    spans.reserve(WIDTH * screenHeight);
+    std::string frame;
+    frame.reserve(64 * 1024);
+    FrameWriter writer(1024);
+    if (nonBlocking) writer.open(fds[1]);
+    run.stayedBlocking = !(fcntl(fds[1], F_GETFL) & O_NONBLOCK);
+
+    Clock::duration frameInterval = std::chrono::nanoseconds(1000000000 / FPS);
+    Clock::duration step = std::chrono::milliseconds(TICK_MS);
+    Clock::duration accumulator(0);
+    Clock::time_point lastFrameStart = start;
+    bool redraw = true;
+    sim.spawnFruit();
+    for (;;) {
+        Clock::time_point frameStart = Clock::now();
+        if (frameStart >= drainAt + DRAINED_TIME) break;
+        if (run.frames > 0) accumulator += std::min<Clock::duration>(frameStart - lastFrameStart, MAX_FRAME_TIME);
+        lastFrameStart = frameStart;
+        while (accumulator >= step) {
+            accumulator -= step;
+            if (sim.fruitRow() == HEIGHT / 2 && sim.spawnedCount() % 3 == 0) sim.sortInto(sim.fruitIndex());
+            sim.tick();
+            sim.spawnFruit();
+            run.ticks++;
+        }
+
+        bool send = !nonBlocking || writer.beginFrame();
+        if (writer.takeRedraw()) redraw = true;
+        if (send) {
+            screen.clear();
+            screen.text(0, 0, "Score: " + std::to_string(sim.getScore()), Style::Status);
+            drawPlayfield(screen, HEADER_ROWS, sim, GlyphMode::Braille,
+                          std::chrono::duration<float>(accumulator) / std::chrono::duration<float>(step));
+            frame.clear();
+            if (redraw || !diffFrames(shown, screen, spans)) {
+                frame += "\x1b[H";
+                screen.emit(frame, theme, true);
+                redraw = false;
+            } else {
+                emitChanges(frame, theme, screen, spans);
+            }
+            std::swap(screen, shown);
+            if (!frame.empty()) {
+                if (nonBlocking) {
+                    writer.send(frame);
+                } else {
+                    for (std::size_t at = 0; at < frame.size();) {
+                        ssize_t count = write(fds[1], frame.data() + at, frame.size() - at);
+                        if (count <= 0) break;
+                        at += count;
+                    }
+                }
+            }
+            run.sent++;
+        } else {
+            run.dropped++;
+            if (frameStart >= drainAt + SETTLE_TIME) run.droppedAfterDrain++;
+        }
+        run.frames++;
+        run.maxFrameMs = std::max(
+            run.maxFrameMs, std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+        std::this_thread::sleep_until(frameStart + frameInterval);
+    }
+    run.expectedTicks = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count() / TICK_MS;
+
+    writer.close();
+    close(fds[1]);
+    const std::string& stream = link.finish();
+    close(fds[0]);
+    std::vector<char32_t> rebuilt = rebuildScreen(stream.substr(backlog.size()), WIDTH, screenHeight);
+    run.screenMatches = true;
+    for (int y = 0; y < screenHeight; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            if (rebuilt[y * WIDTH + x] != cellGlyph(shown.at(x, y))) run.screenMatches = false;
+        }
+    }
+    return run;
+}
+
+int main(int argc, char** argv) {
+    double congested = argc > 1 ? std::atof(argv[1]) : 3;
+    bool ok = true;
+    for (bool nonBlocking : {false, true}) {
+        LinkRun run = play(nonBlocking, congested);
+        double seconds = congested + std::chrono::duration<double>(DRAINED_TIME).count();
+        std::printf("%-12s %4ld of %4ld ticks  longest frame %7.1f ms  %4ld frames, %4ld dropped (%ld after "
+                    "draining), %5.1f sent/s  screen %s%s\n",
+                    nonBlocking ? "FrameWriter" : "blocking", run.ticks, run.expectedTicks, run.maxFrameMs,
+                    run.frames, run.dropped, run.droppedAfterDrain, run.sent / seconds,
+                    run.screenMatches ? "matches" : "DIFFERS",
+                    run.stayedBlocking ? "" : ", descriptor left NON-BLOCKING");
+        if (!run.screenMatches || !run.stayedBlocking) ok = false;
+        if (nonBlocking) {
+            double frameMs = 1000.0 / FPS;
+            if (run.ticks < run.expectedTicks - 1 || run.maxFrameMs > frameMs || run.dropped == 0 ||
+                run.droppedAfterDrain > 0) {
+                ok = false;
+            }
+        }
+    }
+    if (!ok) std::printf("backpressure check failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+// Startup cost of decoding a large fruit catalog: the one-pass SAX binder
+// against json::parse followed by the generated from_json.
+//
+//   catalog_bench [fruit_types]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "../src/catalog.h"
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char** argv) {
+    int types = argc > 1 ? std::atoi(argv[1]) : 10000;
+    const int repetitions = 20;
+
+    Catalog catalog;
+    for (int i = 0; i < types; i++) {
+        std::string type = "fruit_type_" + std::to_string(i);
+        char symbol = static_cast<char>('A' + i % 26);
+        catalog.fruits.push_back(Fruit{type, symbol});
+        catalog.baskets.push_back(Basket{i * 3, type, symbol});
+    }
+    const std::string text = catalogToJson(catalog);
+    std::printf("catalog: %d fruit types, %zu KiB\n", types, text.size() / 1024);
+
+    std::string error;
+    double saxMs = 1e9;
+    double domMs = 1e9;
+    for (int r = 0; r < repetitions; r++) {
+        Catalog sax;
+        auto start = Clock::now();
+        bool ok = parseCatalog(text, sax, error);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (!ok || sax.fruits.size() != catalog.fruits.size()) {
+            std::fprintf(stderr, "SAX decode failed: %s\n", error.c_str());
+            return 1;
+        }
+        if (ms < saxMs) saxMs = ms;
+
+        Catalog dom;
+        start = Clock::now();
+        ok = parseCatalogDom(text, dom, error);
+        ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (!ok || dom.baskets.size() != catalog.baskets.size()) {
+            std::fprintf(stderr, "DOM decode failed: %s\n", error.c_str());
+            return 1;
+        }
+        if (ms < domMs) domMs = ms;
+    }
+    std::printf("SAX binder        %8.3f ms (best of %d)\n", saxMs, repetitions);
+    std::printf("DOM + from_json   %8.3f ms (best of %d)\n", domMs, repetitions);
+    return 0;
+}
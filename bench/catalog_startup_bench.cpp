@@ -0,0 +1,41 @@
+// Startup cost of getting the fruit catalog: the generated constexpr tables
+// against loading data/catalog.json at runtime.
+//
+//   catalog_startup_bench [catalog.json]
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "../src/builtin_catalog.h"
+#include "../src/catalog.h"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+static void measure(const char* name, F load) {
+    const int repetitions = 1000;
+    double first = 0;
+    double best = 1e18;
+    for (int r = 0; r < repetitions; r++) {
+        auto start = Clock::now();
+        Catalog catalog = load();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (catalog.fruits.empty()) std::fprintf(stderr, "%s: empty catalog\n", name);
+        if (r == 0) first = ns;
+        if (ns < best) best = ns;
+    }
+    std::printf("%-16s first %10.0f ns  best %10.0f ns\n", name, first, best);
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "data/catalog.json";
+    measure("constexpr tables", [] { return builtinCatalog(); });
+    measure("runtime JSON", [&path] {
+        Catalog catalog;
+        std::string error;
+        if (!loadCatalog(path, catalog, error)) std::fprintf(stderr, "%s\n", error.c_str());
+        return catalog;
+    });
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Frame diffing on a 300x100 framebuffer: an unchanged frame, one changed
+// cell, and the row comparator scanning equal rows with each instruction
+// set. Then bytes per frame over a played-out game, emitting whole frames
+// against emitting only the changes. Checks that spans cover exactly the
+// changed cells, and fails if diffing an unchanged frame takes 1 us or more.
+//
+//   frame_diff_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/frame_diff.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDE = 300;
+const int TALL = 100;
+
+static double nsSince(Clock::time_point start, int iterations) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+static void fill(Framebuffer& screen, unsigned seed) {
+    std::mt19937 random(seed);
+    screen.clear();
+    for (int y = 0; y < screen.getHeight(); y++) {
+        for (int x = 0; x < screen.getWidth(); x++) {
+            if (random() % 3 == 0) screen.put(x, y, 'a' + random() % 26, fruitStyle(random() % 8));
+        }
+    }
+}
+
+// Every differing cell is in exactly one span, and no span reaches past
+// a changed cell by more than the merge gap.
+static bool spansCoverChanges(const Framebuffer& a, const Framebuffer& b, const std::vector<Span>& spans) {
+    std::vector<int> covered(static_cast<std::size_t>(a.getWidth()) * a.getHeight(), 0);
+    for (const Span& span : spans) {
+        if (a.at(span.begin, span.row) == b.at(span.begin, span.row)) return false;
+        if (a.at(span.end - 1, span.row) == b.at(span.end - 1, span.row)) return false;
+        for (int x = span.begin; x < span.end; x++) covered[span.row * a.getWidth() + x]++;
+    }
+    for (int y = 0; y < a.getHeight(); y++) {
+        for (int x = 0; x < a.getWidth(); x++) {
+            int count = covered[y * a.getWidth() + x];
+            if (count > 1 || (a.at(x, y) != b.at(x, y) && count == 0)) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+    bool ok = true;
+    std::vector<Span> spans;
+    spans.reserve(WIDE * TALL);
+
+    Framebuffer previous(WIDE, TALL);
+    Framebuffer current(WIDE, TALL);
+    fill(previous, 1);
+    fill(current, 1);
+
+    auto start = Clock::now();
+    std::size_t found = 0;
+    for (int i = 0; i < iterations; i++) {
+        diffFrames(previous, current, spans);
+        found += spans.size();
+    }
+    double unchangedNs = nsSince(start, iterations);
+    std::printf("unchanged 300x100      %8.1f ns/diff  (%zu spans)\n", unchangedNs, found);
+    if (found != 0 || unchangedNs >= 1000) ok = false;
+
+    current.put(WIDE / 2, TALL / 2, '@', Style::Status);
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) diffFrames(previous, current, spans);
+    std::printf("one cell changed       %8.1f ns/diff  (%zu span)\n", nsSince(start, iterations), spans.size());
+    if (spans.size() != 1 || spans[0].begin != WIDE / 2 || spans[0].end != WIDE / 2 + 1) ok = false;
+
+    // Rows that hash differently but compare equal up to the last cell:
+    // the comparator scans the whole row
+    std::vector<Cell> rowA(WIDE, packCell(' ', Style::Default));
+    std::vector<Cell> rowB = rowA;
+    rowB.back() = packCell('x', Style::Default);
+    std::pair<const char*, RowComparator> comparators[] = {
+        {"scalar", scalarComparator()}, {"sse2", sse2Comparator()}, {"avx2", avx2Comparator()}};
+    for (auto& [isa, compare] : comparators) {
+        if (!compare) {
+            std::printf("row scan %-6s        unsupported\n", isa);
+            continue;
+        }
+        start = Clock::now();
+        std::size_t sum = 0;
+        for (int i = 0; i < iterations; i++) sum += compare(rowA.data(), rowB.data(), i & 1, WIDE);
+        double ns = nsSince(start, iterations);
+        std::printf("row scan %-6s        %8.1f ns/row  %6.2f cells/ns  (%zu)\n", isa, ns, WIDE / ns,
+                    sum / iterations);
+    }
+    std::printf("dispatch: %s\n", firstDifferenceIsa());
+
+    for (unsigned seed = 2; seed < 50; seed++) {
+        fill(current, seed);
+        std::mt19937 random(seed);
+        for (int change = 0; change < static_cast<int>(seed) * 20; change++) {
+            current.put(random() % WIDE, random() % TALL, '#', Style::Hud);
+        }
+        if (!diffFrames(previous, current, spans) || !spansCoverChanges(previous, current, spans)) {
+            std::printf("spans do not cover the changes for seed %u\n", seed);
+            ok = false;
+        }
+        std::swap(previous, current);
+    }
+    if (diffFrames(previous, Framebuffer(WIDE, TALL - 1), spans)) ok = false;
+
+    // The game's frames: full redraws against changes only
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Simulation sim(fruits, SimulationConfig{80, 20, 200, 50, 2, {}}, 7);
+    Theme theme = Theme::dark();
+    Framebuffer screen(80, 25);
+    Framebuffer shown(80, 25);
+    std::string frame;
+    frame.reserve(64 * 1024);
+    double fullBytes = 0;
+    double changedBytes = 0;
+    int frames = 2000;
+    for (int i = 0; i < frames; i++) {
+        sim.spawnFruit();
+        screen.clear();
+        int x = screen.text(0, 0, "Score: ", Style::Status);
+        screen.text(x, 0, std::to_string(sim.getScore()), Style::Status);
+        drawPlayfield(screen, 3, sim);
+        frame.clear();
+        fullBytes += screen.emit(frame, theme);
+        frame.clear();
+        diffFrames(shown, screen, spans);
+        changedBytes += emitChanges(frame, theme, screen, spans);
+        std::swap(screen, shown);
+        if (sim.fruitRow() == 12 && i % 3 != 0) {
+            sim.sortInto(sim.fruitIndex());
+        } else {
+            sim.tick();
+        }
+    }
+    std::printf("game frames: %.0f bytes full, %.0f bytes changes only (%.1f%%)\n", fullBytes / frames,
+                changedBytes / frames, 100 * changedBytes / fullBytes);
+
+    if (!ok) std::printf("frame diff check failed\n");
+    return ok ? 0 : 1;
+}
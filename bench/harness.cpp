@@ -0,0 +1,257 @@
+#include "harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../src/json_instances.h"
+
+namespace bench {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}  // namespace
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0;
+    std::size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double upper = values[middle];
+    if (values.size() % 2 == 1) return upper;
+    double lower = *std::max_element(values.begin(), values.begin() + middle);
+    return (lower + upper) / 2;
+}
+
+double medianAbsoluteDeviation(const std::vector<double>& values) {
+    double center = median(values);
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double value : values) deviations.push_back(std::fabs(value - center));
+    return median(deviations);
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--reps") == 0) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--warmup-ms") == 0) {
+            options.warmupMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--rep-ms") == 0) {
+            options.repetitionMs = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--filter") == 0) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(arg, "--json") == 0) {
+            options.jsonPath = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0) {
+            options.baselinePath = argv[++i];
+        } else if (std::strcmp(arg, "--threshold") == 0) {
+            options.thresholdPercent = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--alpha") == 0) {
+            options.alpha = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--gate") == 0) {
+            std::string list = argv[++i];
+            for (std::size_t start = 0; start <= list.size();) {
+                std::size_t end = std::min(list.find(',', start), list.size());
+                if (end > start) {
+                    std::string rule = list.substr(start, end - start);
+                    std::size_t colon = rule.find(':');
+                    double threshold = colon == std::string::npos ? -1 : std::atof(rule.c_str() + colon + 1);
+                    options.gate.push_back(GateRule{rule.substr(0, colon), threshold});
+                }
+                start = end + 1;
+            }
+        }
+    }
+    return options;
+}
+
+double mannWhitneyGreater(const std::vector<double>& slower, const std::vector<double>& faster) {
+    std::size_t n1 = slower.size();
+    std::size_t n2 = faster.size();
+    if (n1 == 0 || n2 == 0) return 1;
+
+    // Rank the pooled samples, giving ties their average rank
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(n1 + n2);
+    for (double value : slower) pooled.emplace_back(value, true);
+    for (double value : faster) pooled.emplace_back(value, false);
+    std::sort(pooled.begin(), pooled.end(),
+              [](const std::pair<double, bool>& a, const std::pair<double, bool>& b) {
+                  return a.first < b.first;
+              });
+    double rankSum = 0;
+    double tieTerm = 0;
+    for (std::size_t i = 0; i < pooled.size();) {
+        std::size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) j++;
+        double rank = (i + 1 + j) / 2.0;
+        for (std::size_t k = i; k < j; k++) {
+            if (pooled[k].second) rankSum += rank;
+        }
+        double t = static_cast<double>(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double n = static_cast<double>(n1 + n2);
+    double u = rankSum - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) return u > mean ? 0 : 1;
+    // Continuity correction towards the mean
+    double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+void Harness::run(const std::string& name, const std::function<void(std::uint64_t)>& op,
+                  const std::function<void()>& setup) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+    // Calibrate: double the iterations until one repetition is long enough,
+    // then keep running until the warm-up time is used up
+    std::uint64_t iterations = 1;
+    Clock::time_point warmupStart = Clock::now();
+    for (;;) {
+        if (setup) setup();
+        Clock::time_point start = Clock::now();
+        op(iterations);
+        double ms = msSince(start);
+        if (ms < options.repetitionMs && iterations < (std::uint64_t(1) << 40)) {
+            iterations *= 2;
+        } else if (msSince(warmupStart) >= options.warmupMs) {
+            break;
+        }
+    }
+
+    Result result{name, iterations, {}, 0, 0, 0, 0};
+    std::vector<double> cyclesPerOp;
+    result.samplesNs.reserve(options.repetitions);
+    cyclesPerOp.reserve(options.repetitions);
+    for (int r = 0; r < options.repetitions; r++) {
+        if (setup) setup();
+        Clock::time_point start = Clock::now();
+        std::uint64_t startCycles = cycles();
+        op(iterations);
+        std::uint64_t endCycles = cycles();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        result.samplesNs.push_back(ns / iterations);
+        cyclesPerOp.push_back(static_cast<double>(endCycles - startCycles) / iterations);
+    }
+    result.medianNs = median(result.samplesNs);
+    result.madNs = medianAbsoluteDeviation(result.samplesNs);
+    result.minNs = *std::min_element(result.samplesNs.begin(), result.samplesNs.end());
+    result.cyclesPerOp = median(cyclesPerOp);
+
+    std::printf("%-28s %12.1f ns/op  +- %8.1f  %12.0f cycles/op  (%llu x %d)\n", name.c_str(),
+                result.medianNs, result.madNs, result.cyclesPerOp,
+                static_cast<unsigned long long>(iterations), options.repetitions);
+    std::fflush(stdout);
+    results.push_back(result);
+}
+
+int Harness::compareWithBaseline() const {
+    std::ifstream in(options.baselinePath);
+    nlohmann::json baseline = nlohmann::json::parse(in, nullptr, false);
+    if (!in || baseline.is_discarded() || !baseline.contains("results")) {
+        std::fprintf(stderr, "cannot read baseline %s\n", options.baselinePath.c_str());
+        return 2;
+    }
+
+    std::printf("\ncomparison with %s (threshold %.1f%%, alpha %g)\n",
+                options.baselinePath.c_str(), options.thresholdPercent, options.alpha);
+    int regressions = 0;
+    for (const Result& result : results) {
+        const nlohmann::json* stored = nullptr;
+        for (const auto& entry : baseline["results"]) {
+            if (entry.value("name", "") == result.name) stored = &entry;
+        }
+        if (!stored) {
+            std::printf("  %-28s %12s -> %10.1f ns/op  (not in baseline)\n", result.name.c_str(), "",
+                        result.medianNs);
+            continue;
+        }
+        std::vector<double> before = stored->value("samples_ns", std::vector<double>());
+        double beforeMedian = stored->value("median_ns", median(before));
+        double change = beforeMedian > 0 ? 100.0 * (result.medianNs - beforeMedian) / beforeMedian : 0;
+        double p = mannWhitneyGreater(result.samplesNs, before);
+
+        bool gated = options.gate.empty();
+        double threshold = options.thresholdPercent;
+        std::size_t matched = 0;
+        for (const GateRule& rule : options.gate) {
+            if (result.name.compare(0, rule.prefix.size(), rule.prefix) != 0) continue;
+            gated = true;
+            if (rule.prefix.size() >= matched) {
+                matched = rule.prefix.size();
+                threshold = rule.thresholdPercent < 0 ? options.thresholdPercent : rule.thresholdPercent;
+            }
+        }
+        bool regressed = change > threshold && p < options.alpha;
+        const char* verdict = !regressed ? "ok" : gated ? "REGRESSION" : "slower (not gated)";
+        if (regressed && gated) regressions++;
+        std::printf("  %-28s %12.1f -> %10.1f ns/op  %+7.1f%%  p=%-8.2g %s", result.name.c_str(),
+                    beforeMedian, result.medianNs, change, p, verdict);
+        if (threshold != options.thresholdPercent) std::printf(" (threshold %.1f%%)", threshold);
+        std::printf("\n");
+    }
+    if (regressions > 0) {
+        std::printf("%d benchmark%s regressed\n", regressions, regressions == 1 ? "" : "s");
+        return 1;
+    }
+    std::printf("no regressions\n");
+    return 0;
+}
+
+int Harness::finish() {
+    int status = options.baselinePath.empty() ? 0 : compareWithBaseline();
+    if (options.jsonPath.empty()) return status;
+    nlohmann::json report;
+    report["schema"] = 1;
+    report["timestamp"] = static_cast<std::int64_t>(std::time(nullptr));
+    report["compiler"] = __VERSION__;
+    nlohmann::json& cases = report["results"];
+    cases = nlohmann::json::array();
+    for (const Result& result : results) {
+        cases.push_back({{"name", result.name},
+                         {"iterations", result.iterations},
+                         {"median_ns", result.medianNs},
+                         {"mad_ns", result.madNs},
+                         {"min_ns", result.minNs},
+                         {"cycles_per_op", result.cyclesPerOp},
+                         {"samples_ns", result.samplesNs}});
+    }
+    std::ofstream out(options.jsonPath);
+    out << report.dump(2) << "\n";
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", options.jsonPath.c_str());
+        return 2;
+    }
+    return status;
+}
+
+}  // namespace bench
@@ -0,0 +1,106 @@
+#pragma once
+
+// Minimal microbenchmark harness shared by the suite benches.
+//
+//   bench::Harness harness(argc, argv);
+//   harness.run("tick", [&](std::uint64_t iterations) {
+//       for (std::uint64_t i = 0; i < iterations; i++) sim.tick();
+//   });
+//   return harness.finish();
+//
+// Each case is warmed up while the iteration count is calibrated so one
+// repetition takes about --rep-ms, then timed for --reps repetitions. The
+// report gives the median and median absolute deviation of ns/op over the
+// repetitions, and TSC cycles/op. With --json <path> every repetition is
+// also written out, so later runs can be compared against it.
+//
+// With --baseline <path> each case is compared against the same case in a
+// stored results file. A case regresses when its median is more than
+// --threshold percent slower and a one-sided Mann-Whitney U test over the
+// repetitions says the slowdown is significant at --alpha. finish() prints
+// the comparison and fails if any gated case regressed; --gate limits the
+// gate to cases starting with one of the comma-separated prefixes. A prefix
+// written as prefix:percent gets its own threshold, for cases that drift
+// more between runs than the rest; the longest matching prefix applies.
+//
+//   --reps N  --warmup-ms N  --rep-ms N  --filter substring  --json path
+//   --baseline path  --threshold percent  --alpha p  --gate prefix[:percent],...
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Result {
+    std::string name;
+    std::uint64_t iterations;       // per repetition
+    std::vector<double> samplesNs;  // ns/op of each repetition
+    double medianNs;
+    double madNs;
+    double minNs;
+    double cyclesPerOp;             // median, in TSC reference cycles
+};
+
+struct GateRule {
+    std::string prefix;
+    double thresholdPercent;        // negative for --threshold
+};
+
+struct Options {
+    int repetitions = 25;
+    int warmupMs = 100;
+    double repetitionMs = 2;
+    std::string filter;
+    std::string jsonPath;
+    std::string baselinePath;
+    double thresholdPercent = 5;
+    double alpha = 0.01;
+    std::vector<GateRule> gate;     // empty gates every case
+};
+
+// One-sided p-value that the values in slower tend to be larger than those
+// in faster (Mann-Whitney U, normal approximation with tie correction).
+double mannWhitneyGreater(const std::vector<double>& slower, const std::vector<double>& faster);
+
+// Keeps the compiler from discarding a value the benchmark computes.
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+double median(std::vector<double> values);
+// Median absolute deviation from the median.
+double medianAbsoluteDeviation(const std::vector<double>& values);
+
+// Parses the options above from argv; unknown arguments are left to the
+// caller.
+Options parseOptions(int argc, char** argv);
+
+class Harness {
+private:
+    Options options;
+    std::vector<Result> results;
+
+    int compareWithBaseline() const;
+
+public:
+    explicit Harness(const Options& options) : options(options) {}
+    Harness(int argc, char** argv) : options(parseOptions(argc, argv)) {}
+
+    // op(n) must run the measured operation n times. setup, if given, runs
+    // untimed before every call of op, for cases whose state op uses up.
+    void run(const std::string& name, const std::function<void(std::uint64_t)>& op,
+             const std::function<void()>& setup = nullptr);
+
+    const std::vector<Result>& getResults() const { return results; }
+    const Options& getOptions() const { return options; }
+
+    // Writes the JSON report if --json was given and runs the baseline
+    // comparison if --baseline was. Returns the process exit status: 1 for
+    // a regression, 2 if the baseline or report cannot be used.
+    int finish();
+};
+
+}  // namespace bench
@@ -0,0 +1,108 @@
+// The game loop's fixed-step accumulator on a virtual clock: a 20 Hz
+// simulation drawn at 20, 60 and 120 frames per second in braille mode.
+// Reports simulation and draw cost per second of game time, bytes per
+// second through the frame diff, and the largest jump of the fruit
+// between frames. Fails if the tick count depends on the frame rate or if
+// frames above the tick rate do not move the fruit in smaller steps.
+//
+//   interpolation_bench [seconds]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/frame_diff.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+const int TICK_MS = 50;
+
+struct RunStats {
+    long ticks;
+    double simulateNs;
+    double drawNs;
+    double bytes;
+    double maxJumpRows;
+};
+
+static RunStats play(int fps, int seconds) {
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Simulation sim(fruits, SimulationConfig{WIDTH, HEIGHT, TICK_MS, TICK_MS, 0, {}}, 7);
+    Theme theme = Theme::dark();
+    Framebuffer screen(WIDTH, HEIGHT);
+    Framebuffer shown(WIDTH, HEIGHT);
+    std::vector<Span> spans;
+    spans.reserve(WIDTH * HEIGHT);
+    std::string frame;
+    frame.reserve(64 * 1024);
+
+    RunStats stats{0, 0, 0, 0, 0};
+    // Virtual time in microseconds, as the loop would see it
+    long frameUs = 1000000 / fps;
+    long stepUs = TICK_MS * 1000;
+    long accumulator = 0;
+    double lastRow = -1;
+    int lastFruit = -1;
+    sim.spawnFruit();
+    for (long now = 0; now < seconds * 1000000L; now += frameUs) {
+        if (now > 0) accumulator += frameUs;
+        auto start = Clock::now();
+        while (accumulator >= stepUs) {
+            accumulator -= stepUs;
+            // The player sorts every third fruit halfway down
+            if (sim.fruitRow() == HEIGHT / 2 && sim.spawnedCount() % 3 == 0) sim.sortInto(sim.fruitIndex());
+            sim.tick();
+            sim.spawnFruit();
+            stats.ticks++;
+        }
+        auto simulated = Clock::now();
+        float alpha = static_cast<float>(accumulator) / stepUs;
+        screen.clear();
+        drawPlayfield(screen, 0, sim, GlyphMode::Braille, alpha);
+        frame.clear();
+        diffFrames(shown, screen, spans);
+        stats.bytes += emitChanges(frame, theme, screen, spans);
+        std::swap(screen, shown);
+        auto drawn = Clock::now();
+        stats.simulateNs += std::chrono::duration<double, std::nano>(simulated - start).count();
+        stats.drawNs += std::chrono::duration<double, std::nano>(drawn - simulated).count();
+
+        double row = sim.previousFruitRow() + (sim.fruitRow() - sim.previousFruitRow()) * alpha;
+        if (sim.fruit() && sim.spawnedCount() == lastFruit && lastRow >= 0) {
+            stats.maxJumpRows = std::max(stats.maxJumpRows, std::fabs(row - lastRow));
+        }
+        lastRow = sim.fruit() ? row : -1;
+        lastFruit = sim.spawnedCount();
+    }
+    return stats;
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 600;
+    bool ok = true;
+    long baseTicks = -1;
+    double baseJump = 0;
+    for (int fps : {20, 60, 120}) {
+        RunStats stats = play(fps, seconds);
+        std::printf("%3d fps  %5ld ticks  simulate %7.0f ns/s  draw %8.0f ns/s  %6.0f bytes/s  "
+                    "max jump %.2f rows\n",
+                    fps, stats.ticks, stats.simulateNs / seconds, stats.drawNs / seconds,
+                    stats.bytes / seconds, stats.maxJumpRows);
+        if (baseTicks < 0) {
+            baseTicks = stats.ticks;
+            baseJump = stats.maxJumpRows;
+        } else if (stats.ticks != baseTicks || stats.maxJumpRows >= baseJump) {
+            ok = false;
+        }
+    }
+    if (!ok) std::printf("interpolation check failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// Load time and heap allocation count of a large profile: default
+// nlohmann::json against the arena-backed ArenaJson, plus the cost of
+// freeing each document.
+//
+//   json_arena_bench [history_entries]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "../src/json_instances.h"
+#include "../src/json_arena.h"
+#include "../src/save_files.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::size_t heapAllocations = 0;
+
+// The replacements below pair malloc/free on purpose
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int entries = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const std::string path = "/tmp/fruit_profile_bench.json";
+
+    Profile profile{"benchmark_player_name", entries, 0, 0, 0, {}, {}};
+    for (int i = 0; i < 64; i++) profile.achievements.push_back("Achievement number " + std::to_string(i));
+    for (int i = 0; i < entries; i++) {
+        profile.history.push_back(SessionRecord{1700000000LL + i, i % 5000, i % 300, i % 40,
+                                                (i * 7919) % 600000, static_cast<GameMode>(i % 4)});
+    }
+    std::string error;
+    if (!saveProfile(path, profile, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+    std::printf("profile: %d history entries, %.1f MiB\n", entries, text.size() / (1024.0 * 1024.0));
+
+    {
+        std::size_t before = heapAllocations;
+        auto start = Clock::now();
+        nlohmann::json* doc = new nlohmann::json(nlohmann::json::parse(text));
+        double parseMs = msSince(start);
+        std::size_t allocations = heapAllocations - before;
+        start = Clock::now();
+        delete doc;
+        std::printf("nlohmann::json  parse %8.2f ms  %9zu allocations  free %8.2f ms\n",
+                    parseMs, allocations, msSince(start));
+    }
+    {
+        ArenaDocument doc;
+        std::size_t before = heapAllocations;
+        auto start = Clock::now();
+        doc.parse(text, error);
+        double parseMs = msSince(start);
+        std::size_t allocations = heapAllocations - before;
+        std::size_t arenaAllocations = doc.arena().allocations();
+        start = Clock::now();
+        doc.clear();
+        std::printf("ArenaJson       parse %8.2f ms  %9zu allocations  free %8.2f ms"
+                    "  (%zu arena allocations)\n",
+                    parseMs, allocations, msSince(start), arenaAllocations);
+    }
+    {
+        Profile loaded;
+        std::size_t before = heapAllocations;
+        auto start = Clock::now();
+        loadProfile(path, loaded, error);
+        std::printf("loadProfile     total %8.2f ms  %9zu allocations\n", msSince(start),
+                    heapAllocations - before);
+    }
+    return 0;
+}
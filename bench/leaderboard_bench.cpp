@@ -0,0 +1,156 @@
+// Builds a large leaderboard file, then times opening it, answering top-K,
+// rank and around-me queries and submitting scores, then closing it and
+// opening it again with the submitted scores read back from the side file.
+// Also checks that rebuilding the file keeps the scores left in the side
+// file.
+//
+//   leaderboard_bench [path] [entries]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/leaderboard.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double nsSince(Clock::time_point start, long long ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+static ScoreEntry makeEntry(std::int64_t score, std::int64_t timestamp) {
+    ScoreEntry entry{};
+    entry.score = score;
+    entry.timestamp = timestamp;
+    setPlayerName(entry, "player");
+    return entry;
+}
+
+// Two scores submitted and not merged, then a build of three scores that
+// include one of them: the rebuilt file holds four
+static bool buildKeepsPending(const std::string& path) {
+    std::string error;
+    if (!Leaderboard::build(path, {makeEntry(10, 1), makeEntry(20, 2)}, error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    {
+        Leaderboard leaderboard(path);
+        if (!leaderboard.open(error)) {
+            std::cerr << error << "\n";
+            return false;
+        }
+        leaderboard.submit(makeEntry(30, 3));
+        leaderboard.submit(makeEntry(40, 4));
+    }
+    if (!Leaderboard::build(path, {makeEntry(50, 5), makeEntry(40, 4), makeEntry(60, 6)}, error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    Leaderboard leaderboard(path);
+    if (!leaderboard.open(error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    std::vector<ScoreEntry> top = leaderboard.top(10);
+    bool ok = top.size() == 4 && top[0].score == 60 && top[1].score == 50 && top[2].score == 40 &&
+              top[3].score == 30;
+    std::printf("build keeps pending scores: %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "/tmp/fruit_leaderboard.dat";
+    long long count = argc > 2 ? std::atoll(argv[2]) : 20000000;
+    std::string error;
+
+    {
+        std::vector<ScoreEntry> entries(count);
+        unsigned seed = 12345;
+        for (long long i = 0; i < count; i++) {
+            seed = seed * 1103515245 + 12345;
+            entries[i].score = seed % 1000000;
+            entries[i].timestamp = 1700000000LL + i;
+            setPlayerName(entries[i], "player");
+        }
+        auto start = Clock::now();
+        if (!Leaderboard::build(path, std::move(entries), error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::printf("build   %lld entries: %.2f s\n", count, nsSince(start, 1) / 1e9);
+    }
+
+    auto leaderboard = std::make_unique<Leaderboard>(path);
+    auto start = Clock::now();
+    if (!leaderboard->open(error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::printf("open    %10.0f ns\n", nsSince(start, 1));
+
+    const int queries = 100000;
+    unsigned seed = 777;
+    std::uint64_t checksum = 0;
+
+    start = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        seed = seed * 1103515245 + 12345;
+        checksum += leaderboard->rankOf(seed % 1000000);
+    }
+    std::printf("rankOf  %10.0f ns/op\n", nsSince(start, queries));
+
+    start = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        checksum += leaderboard->top(10).size();
+    }
+    std::printf("top10   %10.0f ns/op\n", nsSince(start, queries));
+
+    start = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        seed = seed * 1103515245 + 12345;
+        checksum += leaderboard->around(seed % 1000000, 5).size();
+    }
+    std::printf("around5 %10.0f ns/op\n", nsSince(start, queries));
+
+    start = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        ScoreEntry entry{};
+        seed = seed * 1103515245 + 12345;
+        entry.score = seed % 1000000;
+        entry.timestamp = 1800000000LL + i;
+        leaderboard->submit(entry);
+    }
+    std::printf("submit  %10.0f ns/op (merges run in the background)\n", nsSince(start, queries));
+
+    std::uint64_t submitted = leaderboard->size();
+    start = Clock::now();
+    leaderboard.reset();
+    std::printf("close   %10.0f ns\n", nsSince(start, 1));
+
+    leaderboard = std::make_unique<Leaderboard>(path);
+    start = Clock::now();
+    if (!leaderboard->open(error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::printf("reopen  %10.0f ns\n", nsSince(start, 1));
+    if (leaderboard->size() != submitted) {
+        std::printf("reopened with %llu entries, expected %llu\n",
+                    static_cast<unsigned long long>(leaderboard->size()),
+                    static_cast<unsigned long long>(submitted));
+        return 1;
+    }
+
+    std::printf("checksum %llu\n", static_cast<unsigned long long>(checksum));
+    leaderboard.reset();
+
+    std::string checkPath = path + ".check";
+    bool ok = buildKeepsPending(checkPath);
+    std::remove(checkPath.c_str());
+    std::remove((checkPath + ".pending").c_str());
+    return ok ? 0 : 1;
+}
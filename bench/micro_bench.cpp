@@ -0,0 +1,221 @@
+// Microbenchmark suite for the game's hot paths: frame composition, a full
+// frame written to a null sink, tick update at several entity counts,
+// spawn/despawn, catch resolution, and saving and loading the profile and
+// replay the way the game does. make bench runs it and writes
+// bench_results.json.
+//
+//   micro_bench [--json path] [--filter substring] [--reps N] ...
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "../src/framebuffer.h"
+#include "../src/profile_store.h"
+#include "../src/renderer.h"
+#include "../src/save_data.h"
+#include "../src/simulation.h"
+#include "../src/util.h"
+
+namespace {
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+
+std::vector<Fruit> makeFruits(int count) {
+    const char symbols[] = "ABCGKLMOPRSTWXYZ";
+    std::vector<Fruit> fruits;
+    for (int i = 0; i < count; i++) {
+        fruits.push_back(Fruit{"Fruit" + std::to_string(i), symbols[i % 16]});
+    }
+    return fruits;
+}
+
+SimulationConfig makeConfig(int width = WIDTH, int height = HEIGHT) {
+    return SimulationConfig{width, height, 200, 50, 2, {}};
+}
+
+// The same cells drawGame draws, formatted the same way: status lines into
+// a reused string, playfield and controls.
+void composeFrame(Framebuffer& screen, const Simulation& sim, std::string& status) {
+    screen.clear();
+    status.clear();
+    status += "Score: ";
+    appendNumber(status, sim.getScore());
+    screen.text(0, 0, status, Style::Status);
+    drawPlayfield(screen, 3, sim);
+    screen.text(0, 3 + HEIGHT + 1, "Controls: [1-4] to select basket, [P] perf overlay, [Q] to quit",
+                Style::Controls);
+}
+
+SessionRecord makeSession(int i) {
+    return SessionRecord{1700000000LL + i, i % 5000, i % 300, i % 40, (i * 7919) % 600000,
+                         static_cast<GameMode>(i % 4)};
+}
+
+Profile makeProfile(int sessions) {
+    Profile profile{"player", sessions, 4200, 0, 0, {"First Catch", "Fruit Salad"}, {}};
+    for (int i = 0; i < sessions; i++) profile.history.push_back(makeSession(i));
+    return profile;
+}
+
+void removeProfile(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + ".journal").c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bench::Harness harness(argc, argv);
+    std::vector<Fruit> fruits = makeFruits(4);
+
+    {
+        Simulation sim(fruits, makeConfig(), 1);
+        sim.spawnFruit();
+        for (int i = 0; i < HEIGHT / 2; i++) sim.tick();
+        Framebuffer screen(WIDTH, HEIGHT + 5);
+        Theme theme = Theme::dark();
+        std::string frame;
+        frame.reserve(64 * 1024);
+        std::string status;
+        status.reserve(WIDTH);
+        harness.run("frame/compose", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                composeFrame(screen, sim, status);
+                bench::doNotOptimize(screen.at(0, 0));
+            }
+        });
+
+        harness.run("frame/emit_dark", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                frame.clear();
+                bench::doNotOptimize(screen.emit(frame, theme));
+            }
+        });
+
+        std::FILE* sink = std::fopen("/dev/null", "w");
+        harness.run("frame/draw_null_sink", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                composeFrame(screen, sim, status);
+                frame.clear();
+                screen.emit(frame, theme);
+                std::fwrite(frame.data(), 1, frame.size(), sink);
+                std::fflush(sink);
+            }
+        });
+        std::fclose(sink);
+    }
+
+    // The game has one falling fruit per simulation, so entity count here
+    // means independent simulations ticked together
+    for (int entities : {1, 64, 1024, 16384}) {
+        std::vector<std::unique_ptr<Simulation>> sims;
+        for (int e = 0; e < entities; e++) sims.emplace_back(new Simulation(fruits, makeConfig(), e));
+        harness.run("tick/entities_" + std::to_string(entities), [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                for (auto& sim : sims) {
+                    sim->spawnFruit();
+                    bench::doNotOptimize(sim->tick());
+                }
+            }
+        });
+    }
+
+    {
+        Simulation sim(fruits, makeConfig(), 2);
+        harness.run("spawn_despawn", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                sim.spawnFruit();
+                bench::doNotOptimize(sim.sortInto(0));
+            }
+        });
+    }
+
+    for (int baskets : {4, 16, 64}) {
+        std::vector<Fruit> kinds = makeFruits(baskets);
+        Simulation sim(kinds, makeConfig(baskets * 2), 3);
+        harness.run("catch/baskets_" + std::to_string(baskets), [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                sim.spawnFruit();
+                bench::doNotOptimize(sim.sortInto(sim.fruitIndex()));
+            }
+        });
+    }
+
+    {
+        // What the game does at the end of a session: one session appended
+        // to a profile with a long history, saved through the journal. Each
+        // batch starts again from the same 1000 sessions and an empty
+        // journal that never compacts, so every repetition times the same
+        // appends.
+        const std::string path = "/tmp/fruit_micro_profile.json";
+        std::string error;
+        Profile profile;
+        std::unique_ptr<ProfileStore> store;
+        harness.run("json/profile_store_save_1k", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                profile.gamesPlayed++;
+                profile.history.push_back(makeSession(profile.gamesPlayed));
+                if (!store->save(profile, error)) std::fprintf(stderr, "%s\n", error.c_str());
+            }
+        }, [&] {
+            store.reset();
+            removeProfile(path);
+            profile = makeProfile(1000);
+            store.reset(new ProfileStore(path, SIZE_MAX));
+            Profile loaded;
+            if (!store->load(loaded, error) || !store->save(profile, error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+            }
+        });
+        store.reset();
+
+        // And at startup: a snapshot with a few sessions journaled after it
+        removeProfile(path);
+        profile = makeProfile(1000);
+        {
+            // Compacts on every save, leaving just the snapshot
+            ProfileStore store(path, 0);
+            Profile loaded;
+            if (!store.load(loaded, error) || !store.save(profile, error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+            }
+        }
+        {
+            ProfileStore store(path);
+            Profile loaded;
+            store.load(loaded, error);
+            for (int i = 0; i < 10; i++) {
+                profile.gamesPlayed++;
+                profile.history.push_back(makeSession(profile.gamesPlayed));
+                store.save(profile, error);
+            }
+        }
+        Profile loaded;
+        harness.run("json/profile_store_load_1k", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                ProfileStore store(path);
+                if (!store.load(loaded, error)) std::fprintf(stderr, "%s\n", error.c_str());
+            }
+        });
+        removeProfile(path);
+
+        const std::string replayPath = "/tmp/fruit_micro_replay.json";
+        Replay replay{42, -1, {}};
+        for (int i = 0; i < 1000; i++) {
+            replay.events.push_back(ReplayEvent{i % 3 == 0 ? SimEvent::Dropped : SimEvent::Caught, i % 4, i * 10});
+        }
+        harness.run("json/replay_save_1k", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                if (!saveReplay(replayPath, replay, error)) std::fprintf(stderr, "%s\n", error.c_str());
+            }
+        });
+        std::remove(replayPath.c_str());
+    }
+
+    return harness.finish();
+}
@@ -0,0 +1,66 @@
+// Hardware counters for two layouts of the same fruit data: heap-allocated
+// Fruit objects reached through shuffled pointers, as the game's
+// new Fruit does, against one contiguous vector. Shows what PerfCounters
+// reports for a change that should cut cache misses.
+//
+//   perf_counters_bench [fruits]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/game_types.h"
+#include "../src/perf_counters.h"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+static void measure(PerfCounters& perf, const char* name, F walk) {
+    auto start = Clock::now();
+    PerfSample before = perf.read();
+    std::size_t result = walk();
+    PerfSample counts = perf.read() - before;
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::string line;
+    appendPerfPhase(line, name, counts);
+    std::printf("%s  %.1f ms  (checksum %zu)\n", line.c_str(), ms, result);
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    const char* names[] = {"Apple", "Banana", "Cherry", "Grape"};
+    const char symbols[] = {'A', 'B', 'C', 'G'};
+
+    std::vector<Fruit> contiguous;
+    std::vector<std::unique_ptr<Fruit>> scattered;
+    contiguous.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        Fruit fruit{names[i % 4], symbols[i % 4]};
+        contiguous.push_back(fruit);
+        scattered.emplace_back(new Fruit(fruit));
+    }
+    std::shuffle(scattered.begin(), scattered.end(), std::mt19937(42));
+
+    PerfCounters perf;
+    std::string error;
+    if (!perf.open(error)) {
+        // Still time both walks so the bench is useful without counters
+        std::printf("counters unavailable (%s), timing only\n", error.c_str());
+    }
+    measure(perf, "scattered", [&] {
+        std::size_t sum = 0;
+        for (const auto& fruit : scattered) sum += fruit->symbol;
+        return sum;
+    });
+    measure(perf, "contiguous", [&] {
+        std::size_t sum = 0;
+        for (const auto& fruit : contiguous) sum += fruit.symbol;
+        return sum;
+    });
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Cost of formatting the perf overlay each frame, and its heap allocations,
+// against building the same line with std::ostringstream.
+//
+//   perf_overlay_bench [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "../src/perf_overlay.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::size_t heapAllocations = 0;
+
+// The replacements below pair malloc/free on purpose
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static std::uint32_t frameValue(int i, std::uint32_t base) {
+    return base + static_cast<std::uint32_t>((i * 2654435761u) % (base / 4 + 1));
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 200000;
+    PerfOverlay overlay;
+    overlay.toggle();
+    std::size_t bytes = 0;
+
+    std::size_t before = heapAllocations;
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        overlay.recordFrame(OverlayFrame{frameValue(i, 200000000), frameValue(i, 60000), frameValue(i, 340000),
+                                         1702, i % 10 == 0 ? frameValue(i, 150000000) : 0u, 5, 0, false});
+        bytes += overlay.format().size() + overlay.formatLoad().size();
+    }
+    double overlayNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / frames;
+    std::size_t overlayAllocations = heapAllocations - before;
+
+    before = heapAllocations;
+    start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        std::ostringstream line;
+        line << std::fixed << "  | " << std::setprecision(1) << 1e9 / frameValue(i, 200000000)
+             << " fps  tick " << std::setprecision(2) << frameValue(i, 60000) / 1e6 << "/"
+             << frameValue(i, 60000) / 1e6 << "  draw " << frameValue(i, 340000) / 1e6 << "/"
+             << frameValue(i, 340000) / 1e6 << " ms  input " << std::setprecision(1)
+             << frameValue(i, 150000000) / 1e6 << "/" << frameValue(i, 150000000) / 1e6 << " ms";
+        std::ostringstream load;
+        load << "  | " << 1702 << " B  " << 5 << " entities";
+        bytes += line.str().size() + load.str().size();
+    }
+    double streamNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / frames;
+    std::size_t streamAllocations = heapAllocations - before;
+
+    std::printf("overlay to_chars  %7.1f ns/frame  %zu allocations\n", overlayNs, overlayAllocations);
+    std::printf("ostringstream     %7.1f ns/frame  %zu allocations\n", streamNs, streamAllocations);
+    std::string_view timing = overlay.format();
+    std::printf("sample: %.*s\n", static_cast<int>(timing.size()), timing.data());
+    std::string_view load = overlay.formatLoad();
+    std::printf("        %.*s  (%zu bytes total)\n", static_cast<int>(load.size()), load.data(), bytes);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Bytes written and time per save for journaled profile saves against
+// rewriting the whole profile, as the history grows. Then checks that a
+// journal line that no longer applies fails the load with a fresh profile,
+// and that the damaged files are moved aside rather than saved behind.
+//
+//   profile_store_bench [initial_history] [saves]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+#include "../src/profile_store.h"
+#include "../src/save_files.h"
+
+using Clock = std::chrono::steady_clock;
+
+static long fileSize(const std::string& path) {
+    struct stat info {};
+    return stat(path.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : 0;
+}
+
+static SessionRecord session(int i) {
+    return SessionRecord{1700000000LL + i, i % 5000, i % 300, i % 40, (i * 7919) % 600000,
+                         static_cast<GameMode>(i % 4)};
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static bool damagedJournalRecovers() {
+    const std::string path = "/tmp/fruit_profile_damaged.json";
+    const std::string journalPath = path + ".journal";
+    for (const std::string& file : {path, journalPath, path + ".bad", journalPath + ".bad"}) {
+        std::remove(file.c_str());
+    }
+
+    std::string error;
+    Profile profile{"player", 0, 0, 0, 0, {}, {}};
+    {
+        ProfileStore store(path, 1 << 30);
+        Profile loaded;
+        store.load(loaded, error);
+        for (int i = 0; i < 3; i++) {
+            profile.gamesPlayed++;
+            profile.history.push_back(session(i));
+            store.save(profile, error);
+        }
+    }
+    // Valid JSON, so not taken for a torn tail, but it no longer applies
+    const std::string damaged = "{\"patch\":[{\"op\":\"remove\",\"path\":\"/nope\"}],\"seq\":2}";
+    std::string journal = readFile(journalPath);
+    std::size_t second = journal.find('\n') + 1;
+    journal.replace(second, journal.find('\n', second) - second, damaged);
+    std::ofstream(journalPath) << journal;
+
+    ProfileStore store(path, 1 << 30);
+    Profile loaded;
+    bool loadFailed = !store.load(loaded, error) && loaded.gamesPlayed == 0 && loaded.history.empty();
+    Profile next{"player", 1, 7, 1, 0, {}, {session(100)}};
+    bool saved = store.save(next, error);
+
+    ProfileStore reopened(path, 1 << 30);
+    Profile check;
+    bool reloaded = reopened.load(check, error) && check.gamesPlayed == 1 && check.history.size() == 1;
+    bool keptAside = readFile(journalPath + ".bad") == journal;
+    bool restarted = readFile(journalPath).find("\"seq\":1}") != std::string::npos &&
+                     readFile(journalPath).find(damaged) == std::string::npos;
+    std::printf("damaged journal: load %s, save %s, reload %s, damaged journal %s, new journal %s\n",
+                loadFailed ? "fails fresh" : "WRONG", saved ? "ok" : "FAILED", reloaded ? "ok" : "WRONG",
+                keptAside ? "set aside" : "NOT set aside", restarted ? "started over" : "WRONG");
+    return loadFailed && saved && reloaded && keptAside && restarted;
+}
+
+int main(int argc, char** argv) {
+    int initial = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int saves = argc > 2 ? std::atoi(argv[2]) : 100;
+    const std::string fullPath = "/tmp/fruit_profile_full.json";
+    const std::string journaledPath = "/tmp/fruit_profile_journaled.json";
+    std::remove(journaledPath.c_str());
+    std::remove((journaledPath + ".journal").c_str());
+
+    Profile profile{"player", 0, 0, 0, 0, {"First Catch"}, {}};
+    for (int i = 0; i < initial; i++) profile.history.push_back(session(i));
+
+    std::string error;
+    ProfileStore store(journaledPath, 1 << 30);
+    Profile loaded;
+    if (!store.load(loaded, error) || !store.save(profile, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::size_t journalStart = store.journalSize();
+
+    double fullMs = 0;
+    double journaledMs = 0;
+    long fullBytes = 0;
+    for (int i = 0; i < saves; i++) {
+        profile.gamesPlayed++;
+        profile.history.push_back(session(initial + i));
+
+        auto start = Clock::now();
+        saveProfile(fullPath, profile, error);
+        fullMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        fullBytes += fileSize(fullPath);
+
+        start = Clock::now();
+        store.save(profile, error);
+        journaledMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::printf("history %d sessions, %d saves\n", initial, saves);
+    std::printf("full rewrite  %10.0f bytes/save  %8.2f ms/save\n",
+                static_cast<double>(fullBytes) / saves, fullMs / saves);
+    std::printf("journaled     %10.0f bytes/save  %8.2f ms/save\n",
+                static_cast<double>(store.journalSize() - journalStart) / saves, journaledMs / saves);
+
+    // Reload from snapshot + journal and compare
+    ProfileStore reopened(journaledPath);
+    Profile check;
+    if (!reopened.load(check, error) || check.history.size() != profile.history.size() ||
+        check.gamesPlayed != profile.gamesPlayed) {
+        std::fprintf(stderr, "reload mismatch: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("reload ok, %zu sessions\n", check.history.size());
+    return damagedJournalRecovers() ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// Cost of an enabled profiler zone against the same loop without one (what
+// a build without FRUIT_PROFILE compiles to), and a check that the exported
+// trace is valid trace_event JSON with every zone from every thread.
+//
+//   profiler_bench [iterations] [path]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "../src/json_instances.h"
+#include "../src/profiler.h"
+
+using Clock = std::chrono::steady_clock;
+
+static volatile int sink;
+
+__attribute__((noinline)) static void work(int i) {
+    sink = i;
+}
+
+__attribute__((noinline)) static void zoned(int i) {
+    PROFILE_ZONE("work");
+    sink = i;
+}
+
+template<typename F>
+static double nsPerCall(int iterations, F f) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) f(i);
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    std::string path = argc > 2 ? argv[2] : "/tmp/fruit_trace.json";
+
+    // Warm up: registers the thread and touches the first chunks
+    nsPerCall(iterations, zoned);
+    double bare = nsPerCall(iterations, work);
+    double withZone = nsPerCall(iterations, zoned);
+    std::printf("no zone   %6.2f ns/call\n", bare);
+    std::printf("zone      %6.2f ns/call  (+%.2f ns)\n", withZone, withZone - bare);
+
+    std::thread other([] {
+        for (int i = 0; i < 1000; i++) zoned(i);
+    });
+    other.join();
+
+    std::string error;
+    auto start = Clock::now();
+    if (!profiler::exportTrace(path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    double exportMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::ifstream in(path);
+    nlohmann::json trace = nlohmann::json::parse(in, nullptr, false);
+    if (trace.is_discarded()) {
+        std::fprintf(stderr, "%s is not valid JSON\n", path.c_str());
+        return 1;
+    }
+    std::size_t zones = 0;
+    for (const auto& event : trace["traceEvents"]) zones += event["ph"] == "X";
+    std::size_t expected = static_cast<std::size_t>(iterations) * 2 + 1000;
+    std::printf("export    %zu zones in %.1f ms, %s\n", zones, exportMs,
+                zones == expected ? "all present" : "MISSING ZONES");
+    return zones == expected ? 0 : 1;
+}
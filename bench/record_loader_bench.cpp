@@ -0,0 +1,152 @@
+// Compares the streaming SAX loader against a full json::parse DOM load on a
+// synthetic records file. Each loader runs in its own child process so that
+// peak RSS is measured independently.
+//
+//   record_loader_bench [path] [size_mb]
+//
+// The file is generated at path (default /tmp/fruit_records.json) if it does
+// not exist yet; size_mb defaults to 1024.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/json_instances.h"
+#include "../src/record_loader.h"
+
+using json = nlohmann::json;
+
+static void generate(const std::string& path, long long sizeMb) {
+    static const char* names[] = {"dan", "alex", "kim", "sam", "robin", "lee"};
+    static const char* modes[] = {"classic", "time_attack", "zen", "challenge"};
+    const long long target = sizeMb * 1024 * 1024;
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "cannot write " << path << "\n";
+        std::exit(1);
+    }
+    long long written = std::fprintf(file, "{\"leaderboard\":[");
+    unsigned seed = 12345;
+    long long i = 0;
+    // Half the file is leaderboard entries, half is play history.
+    while (written < target / 2) {
+        seed = seed * 1103515245 + 12345;
+        written += std::fprintf(file, "%s{\"player\":\"%s%u\",\"score\":%u,\"time\":%lld}",
+                                i ? "," : "", names[seed % 6], seed % 1000,
+                                seed % 100000, 1700000000LL + i);
+        i++;
+    }
+    written += std::fprintf(file, "],\"history\":[");
+    i = 0;
+    while (written < target) {
+        seed = seed * 1103515245 + 12345;
+        written += std::fprintf(file,
+                                "%s{\"time\":%lld,\"score\":%u,\"caught\":%u,\"missed\":%u,"
+                                "\"duration_ms\":%u,\"mode\":\"%s\"}",
+                                i ? "," : "", 1700000000LL + i, seed % 5000, seed % 300,
+                                seed % 40, seed % 600000, modes[seed % 4]);
+        i++;
+    }
+    std::fprintf(file, "]}\n");
+    std::fclose(file);
+}
+
+static bool loadDom(const std::string& path, RecordSet& out) {
+    std::ifstream in(path, std::ios::binary);
+    json doc = json::parse(in);
+    for (const auto& item : doc["leaderboard"]) {
+        ScoreEntry entry{};
+        entry.score = item.value("score", 0LL);
+        entry.timestamp = item.value("time", 0LL);
+        setPlayerName(entry, item.value("player", std::string()));
+        out.leaderboard.push_back(entry);
+    }
+    for (const auto& item : doc["history"]) {
+        SessionRecord session{};
+        session.timestamp = item.value("time", 0LL);
+        session.score = item.value("score", 0);
+        session.caught = item.value("caught", 0);
+        session.missed = item.value("missed", 0);
+        session.durationMs = item.value("duration_ms", 0);
+        parseGameMode(item.value("mode", std::string()), session.mode);
+        out.history.push_back(session);
+    }
+    return true;
+}
+
+static void runChild(const std::string& mode, const std::string& path) {
+    std::cout.flush();
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        RecordSet records;
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        bool ok = mode == "sax" ? loadRecords(path, records, error) : loadDom(path, records);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!ok) std::cerr << mode << ": " << error << "\n";
+        std::printf("%-4s %8.2f s  %10zu scores %10zu sessions  ", mode.c_str(), seconds,
+                    records.leaderboard.size(), records.history.size());
+        std::fflush(stdout);
+        std::_Exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    struct rusage usage {};
+    wait4(pid, &status, 0, &usage);
+    if (WIFSIGNALED(status)) {
+        std::printf("%-4s killed by signal %d  ", mode.c_str(), WTERMSIG(status));
+    }
+    std::printf("peak RSS %8.1f MiB\n", usage.ru_maxrss / 1024.0);
+}
+
+// Numbers their field cannot hold fail the load instead of wrapping, or
+// converting out of range
+static bool rejectsOutOfRange() {
+    const char* documents[] = {
+        "{\"leaderboard\":[{\"score\":1e300}]}",
+        "{\"leaderboard\":[{\"time\":18446744073709551615}]}",
+        "{\"history\":[{\"score\":4294967296}]}",
+        "{\"history\":[{\"duration_ms\":-3e9}]}",
+    };
+    bool ok = true;
+    for (const char* document : documents) {
+        RecordSet records;
+        std::string error;
+        if (parseRecords(document, records, error)) {
+            std::printf("accepted %s\n", document);
+            ok = false;
+        }
+    }
+    RecordSet records;
+    std::string error;
+    ok = parseRecords("{\"leaderboard\":[{\"score\":9e18,\"other\":1e300}]}", records, error) &&
+         records.leaderboard.size() == 1 && records.leaderboard[0].score == 9000000000000000000LL && ok;
+    std::printf("out of range numbers rejected: %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "/tmp/fruit_records.json";
+    long long sizeMb = argc > 2 ? std::atoll(argv[2]) : 1024;
+    if (!rejectsOutOfRange()) return 1;
+
+    struct stat info {};
+    if (stat(path.c_str(), &info) != 0) {
+        std::cout << "generating " << sizeMb << " MiB at " << path << "\n";
+        generate(path, sizeMb);
+        stat(path.c_str(), &info);
+    }
+    std::printf("file size %.1f MiB\n", info.st_size / (1024.0 * 1024.0));
+
+    runChild("sax", path);
+    runChild("dom", path);
+    return 0;
+}
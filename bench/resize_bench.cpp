@@ -0,0 +1,126 @@
+// Frame cost against terminal size: the same game played on an 80x25
+// screen and on much larger ones, timing compose (clear and draw) and
+// diff plus emit, per frame and per changed cell. Also checks that
+// resizing back to a size that fitted before keeps the framebuffer's
+// storage, and that lanes follow the width. Fails if diff and emit per
+// changed cell on the largest screen cost more than twice the smallest.
+//
+//   resize_bench [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/frame_diff.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int HEADER_ROWS = 3;
+
+static double nsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Per frame averages of one played-out game
+struct FrameCost {
+    double composeNs;
+    double diffNs;
+    double cells;
+};
+
+static FrameCost playFrames(const std::vector<Fruit>& fruits, const Theme& theme, int columns, int rows,
+                            int frames) {
+    int height = rows - HEADER_ROWS - 3;
+    Simulation sim(fruits, SimulationConfig{columns, height, 200, 50, 2, {}}, 7);
+    Framebuffer screen(columns, HEADER_ROWS + height + 2);
+    Framebuffer shown(columns, HEADER_ROWS + height + 2);
+    std::vector<Span> spans;
+    spans.reserve(static_cast<std::size_t>(columns / 2) * screen.getHeight());
+    std::string frame;
+    frame.reserve(64 * 1024);
+
+    FrameCost total{0, 0, 0};
+    for (int i = 0; i < frames; i++) {
+        sim.spawnFruit();
+        auto start = Clock::now();
+        screen.clear();
+        int x = screen.text(0, 0, "Score: ", Style::Status);
+        screen.text(x, 0, std::to_string(sim.getScore()), Style::Status);
+        drawPlayfield(screen, HEADER_ROWS, sim);
+        screen.text(0, HEADER_ROWS + height + 1,
+                    "Controls: [1-4] to select basket, [P] perf overlay, [Q] to quit", Style::Controls);
+        auto composed = Clock::now();
+        frame.clear();
+        diffFrames(shown, screen, spans);
+        emitChanges(frame, theme, screen, spans);
+        auto emitted = Clock::now();
+        std::swap(screen, shown);
+
+        total.composeNs += nsBetween(start, composed);
+        total.diffNs += nsBetween(composed, emitted);
+        for (const Span& span : spans) total.cells += span.end - span.begin;
+        if (sim.fruitRow() == height / 2 && i % 3 != 0) {
+            sim.sortInto(sim.fruitIndex());
+        } else {
+            sim.tick();
+        }
+    }
+    return FrameCost{total.composeNs / frames, total.diffNs / frames, total.cells / frames};
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 10000;
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Theme theme = Theme::dark();
+    bool ok = true;
+
+    const std::pair<int, int> sizes[] = {{80, 25}, {400, 150}, {1000, 300}};
+    // Best of a few rounds per size, so one noisy round does not decide
+    FrameCost best[3];
+    for (int round = 0; round < 3; round++) {
+        for (int s = 0; s < 3; s++) {
+            FrameCost cost = playFrames(fruits, theme, sizes[s].first, sizes[s].second, frames);
+            if (round == 0 || cost.diffNs < best[s].diffNs) best[s] = cost;
+        }
+    }
+    for (int s = 0; s < 3; s++) {
+        const FrameCost& cost = best[s];
+        std::printf("%4dx%-3d  compose %7.0f ns/frame  diff+emit %6.0f ns/frame  %5.1f cells/frame  "
+                    "%5.1f ns/cell\n",
+                    sizes[s].first, sizes[s].second, cost.composeNs, cost.diffNs, cost.cells,
+                    cost.diffNs / cost.cells);
+    }
+    if (best[2].diffNs / best[2].cells > 2 * best[0].diffNs / best[0].cells) {
+        std::printf("diff and emit per changed cell grow with the screen\n");
+        ok = false;
+    }
+
+    // Shrinking and growing back within the old size must not reallocate
+    Framebuffer screen(1000, 300);
+    const Cell* storage = screen.row(0);
+    auto start = Clock::now();
+    screen.resize(80, 25);
+    screen.resize(400, 150);
+    screen.resize(1000, 300);
+    std::printf("resize round trip %.0f ns, storage %s\n", nsBetween(start, Clock::now()),
+                screen.row(0) == storage ? "kept" : "reallocated");
+    if (screen.row(0) != storage) ok = false;
+
+    Simulation sim(fruits, SimulationConfig{80, 20, 200, 50, 2, {}}, 7);
+    sim.spawnFruit();
+    for (int i = 0; i < 15; i++) sim.tick();
+    sim.resize(200, 10);
+    const std::vector<Basket>& baskets = sim.getBaskets();
+    for (std::size_t i = 0; i < baskets.size(); i++) {
+        if (baskets[i].x != static_cast<int>(i) * 50 + 25) ok = false;
+    }
+    if (sim.fruitRow() != 8) ok = false;
+
+    if (!ok) std::printf("resize check failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// The terminal session on a pseudo-terminal: a child process enters the
+// session, plays frames of a game the way the game loop writes them and
+// then ends by leaving, by exiting, by a fatal signal in the middle of a
+// frame, or after being suspended and resumed, while this process plays
+// the terminal and answers its queries. Fails unless every ending leaves
+// the normal screen and cooked input behind, frames are wrapped in
+// synchronized updates exactly when the terminal confirms the mode, and
+// nothing ever clears the whole screen. Also reports the bytes of a full
+// redraw drawn over the old frame against clearing first, and what the
+// update markers add per frame.
+//
+//   session_bench [frames]
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <pty.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "../src/frame_diff.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+#include "../src/terminal.h"
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+
+const char* const ENTER = "\x1b[?1049h";
+const char* const LEAVE = "\x1b[?1049l";
+const char* const BEGIN_UPDATE = "\x1b[?2026h";
+const char* const END_UPDATE = "\x1b[?2026l";
+
+enum class Ending { Leave, Exit, Signal, Suspend };
+
+// The game loop's frames: the first drawn over the whole screen, the rest
+// as changes, each in a synchronized update when there is anything to send
+class Player {
+public:
+    Player()
+        : sim(fruits, SimulationConfig{WIDTH, HEIGHT, 200, 200, 0, {}}, 7), theme(Theme::dark()),
+          screen(WIDTH, HEIGHT), shown(WIDTH, HEIGHT), redraw(true) {}
+
+    // Appends one frame to out; returns whether it had anything in it
+    bool frame(std::string& out) {
+        sim.spawnFruit();
+        screen.clear();
+        drawPlayfield(screen, 0, sim);
+        std::size_t start = out.size();
+        beginSynchronizedUpdate(out);
+        std::size_t header = out.size();
+        if (redraw || !diffFrames(shown, screen, spans)) {
+            out += "\x1b[H";
+            screen.emit(out, theme, true);
+            redraw = false;
+        } else {
+            emitChanges(out, theme, screen, spans);
+        }
+        std::swap(screen, shown);
+        sim.tick();
+        if (out.size() == header) {
+            out.resize(start);
+            return false;
+        }
+        endSynchronizedUpdate(out);
+        return true;
+    }
+
+    void forceRedraw() { redraw = true; }
+
+    // The current frame drawn over an old one, and after clearing the
+    // screen as the game used to
+    std::size_t overwriteBytes() {
+        std::string out = "\x1b[H";
+        shown.emit(out, theme, true);
+        return out.size();
+    }
+    std::size_t clearBytes() {
+        std::string out = "\x1b[H\x1b[2J";
+        shown.emit(out, theme);
+        return out.size();
+    }
+
+private:
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Simulation sim;
+    Theme theme;
+    Framebuffer screen;
+    Framebuffer shown;
+    std::vector<Span> spans;
+    bool redraw;
+};
+
+// Runs in the child, on the pseudo-terminal; the exit status reports what
+// the child could see go wrong
+static int playSession(Ending ending, int frames) {
+    if (!enterSession(500)) return 2;
+    takeResize();
+    Player player;
+    std::string out;
+    for (int i = 0; i < frames; i++) {
+        out.clear();
+        if (player.frame(out)) std::cout << out << std::flush;
+    }
+    switch (ending) {
+        case Ending::Leave:
+            leaveSession();
+            return 0;
+        case Ending::Exit:
+            return 0;
+        case Ending::Signal:
+            // Killed halfway through writing a frame
+            player.forceRedraw();
+            out.clear();
+            player.frame(out);
+            std::cout << out.substr(0, out.size() / 2) << std::flush;
+            raise(SIGTERM);
+            return 3;
+        case Ending::Suspend:
+            // The child leads its own session, where the kernel discards
+            // stops, so this runs the handlers without stopping
+            raise(SIGTSTP);
+            raise(SIGCONT);
+            if (!takeResize()) return 4;
+            player.forceRedraw();
+            out.clear();
+            player.frame(out);
+            std::cout << out << std::flush;
+            leaveSession();
+            return 0;
+    }
+    return 5;
+}
+
+struct Session {
+    std::string stream;
+    int status;
+    bool cooked;    // echo and line input back on afterwards
+};
+
+// Plays the terminal: answers each device attributes request with reply
+static Session runSession(Ending ending, const char* reply, int frames) {
+    Session session{"", -1, false};
+    int master;
+    pid_t pid = forkpty(&master, nullptr, nullptr, nullptr);
+    if (pid < 0) return session;
+    if (pid == 0) std::exit(playSession(ending, frames));
+
+    std::size_t answered = 0;
+    std::size_t at;
+    pollfd in{master, POLLIN, 0};
+    char buffer[4096];
+    while (poll(&in, 1, 5000) > 0) {
+        ssize_t count = read(master, buffer, sizeof(buffer));
+        if (count <= 0) break;
+        session.stream.append(buffer, count);
+        while ((at = session.stream.find("\x1b[c", answered)) != std::string::npos) {
+            answered = at + 3;
+            if (write(master, reply, std::char_traits<char>::length(reply)) < 0) break;
+        }
+    }
+    waitpid(pid, &session.status, 0);
+    termios settings{};
+    session.cooked = tcgetattr(master, &settings) == 0 && (settings.c_lflag & (ICANON | ECHO)) == (ICANON | ECHO);
+    close(master);
+    return session;
+}
+
+static int countOf(const std::string& stream, const char* what) {
+    int count = 0;
+    for (std::size_t at = 0; (at = stream.find(what, at)) != std::string::npos; at++) count++;
+    return count;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+    const char* synchronizing = "\x1b[?2026;2$y\x1b[?62;22c";
+    const char* plain = "\x1b[?62;22c";
+    bool ok = true;
+
+    // The frames the child writes, to count the updates against
+    int written = 0;
+    {
+        Player player;
+        std::string out;
+        for (int i = 0; i < frames; i++) written += player.frame(out);
+        std::printf("full redraw: %zu bytes drawn over the old frame, %zu clearing first\n",
+                    player.overwriteBytes(), player.clearBytes());
+        std::printf("%d of %d frames written, %.1f bytes/frame, update markers add %zu bytes/frame\n",
+                    written, frames, static_cast<double>(out.size()) / written,
+                    std::char_traits<char>::length(BEGIN_UPDATE) + std::char_traits<char>::length(END_UPDATE));
+    }
+
+    const struct {
+        const char* name;
+        Ending ending;
+        const char* reply;
+        int signal;
+        int enters;
+    } cases[] = {
+        {"leave, synchronized", Ending::Leave, synchronizing, 0, 1},
+        {"leave, plain", Ending::Leave, plain, 0, 1},
+        {"exit", Ending::Exit, synchronizing, 0, 1},
+        {"SIGTERM mid-frame", Ending::Signal, synchronizing, SIGTERM, 1},
+        {"suspend and resume", Ending::Suspend, synchronizing, 0, 2},
+    };
+    for (const auto& test : cases) {
+        Session session = runSession(test.ending, test.reply, frames);
+        const std::string& stream = session.stream;
+        bool ended = test.signal ? WIFSIGNALED(session.status) && WTERMSIG(session.status) == test.signal
+                                 : WIFEXITED(session.status) && WEXITSTATUS(session.status) == 0;
+        bool synchronized = test.reply == synchronizing;
+        int updates = countOf(stream, BEGIN_UPDATE);
+        int expected = !synchronized ? 0
+                       : test.ending == Ending::Signal || test.ending == Ending::Suspend ? written + 1
+                                                                                          : written;
+        std::size_t lastEnter = stream.rfind(ENTER);
+        std::size_t lastLeave = stream.rfind(LEAVE);
+        bool restored = lastLeave != std::string::npos && lastEnter != std::string::npos && lastLeave > lastEnter &&
+                        countOf(stream, LEAVE) == test.enters && session.cooked;
+        // Leaving ends the update a signal cut short
+        int ends = countOf(stream, END_UPDATE) - countOf(stream, LEAVE);
+        int cut = test.ending == Ending::Signal && synchronized ? 1 : 0;
+        bool passed = ended && restored && countOf(stream, ENTER) == test.enters && updates == expected &&
+                      ends == updates - cut && stream.find("\x1b[2J") == std::string::npos;
+        std::printf("%-20s %7zu bytes  %4d updates  %s, %s\n", test.name, stream.size(), updates,
+                    restored ? "restored" : "NOT restored", passed ? "ok" : "FAILED");
+        if (!passed) ok = false;
+    }
+
+    if (!ok) std::printf("session check failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Time per tick of the headless game loop (spawn, sort, tick, achievements,
+// perf overlay) and per frame drawn from it (compose, diff against the last
+// frame, emit the changes), and a steady-state allocation check over both:
+// built with the allocation tracker, any heap allocation after warm-up
+// aborts the bench.
+//
+//   simulation_bench [ticks]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/achievements.h"
+#include "../src/alloc_tracker.h"
+#include "../src/frame_diff.h"
+#include "../src/perf_overlay.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+#include "../src/util.h"
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char** argv) {
+    long ticks = argc > 1 ? std::atol(argv[1]) : 5000000;
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    SimulationConfig config{80, 20, 200, 50, 2, {}};
+    Simulation sim(fruits, config, 42);
+    AchievementEngine achievements;
+    addDefaultAchievements(achievements, {"Apple", "Banana", "Cherry", "Grape"});
+    PerfOverlay overlay;
+    overlay.toggle();
+
+    std::size_t hudBytes = 0;
+    auto step = [&](long i) {
+        ALLOC_PHASE("tick");
+        sim.spawnFruit();
+        SimEvent event = SimEvent::None;
+        // Sort some fruits, misroute some and let the rest drop
+        if (sim.fruitRow() == 5 && i % 3 != 2) {
+            int fruit = sim.fruitIndex();
+            event = sim.sortInto(i % 3 == 0 ? fruit : (fruit + 1) % 4);
+            if (event == SimEvent::Caught) achievements.onCatch(fruit);
+        } else {
+            event = sim.tick();
+        }
+        if (event == SimEvent::WrongBasket || event == SimEvent::Dropped) achievements.onMiss();
+        if (event != SimEvent::None) achievements.onScore(sim.getScore());
+        achievements.clearNewlyUnlocked();
+        overlay.recordFrame(OverlayFrame{200000000, 60000, 340000, 1700, 0, 5, 0, false});
+        hudBytes += overlay.formatLoad().size();
+        hudBytes += overlay.format().size();
+    };
+
+    // The game loop's frame: status line and playfield, sent as the changes
+    // since the last frame
+    const int headerRows = 1;
+    Theme theme = Theme::dark();
+    Framebuffer screen(config.width, headerRows + config.height + 2);
+    Framebuffer shown(config.width, headerRows + config.height + 2);
+    std::vector<Span> spans;
+    spans.reserve(static_cast<std::size_t>(config.width / 2) * screen.getHeight());
+    std::string status;
+    std::string frame;
+    frame.reserve(64 * 1024);
+    std::size_t frameBytes = 0;
+    auto draw = [&] {
+        ALLOC_PHASE("frame");
+        screen.clear();
+        status.clear();
+        status += "Score: ";
+        appendNumber(status, sim.getScore());
+        screen.text(0, 0, status, Style::Status);
+        drawPlayfield(screen, headerRows, sim);
+        frame.clear();
+        if (!diffFrames(shown, screen, spans)) {
+            frame += "\x1b[H";
+            screen.emit(frame, theme, true);
+        } else {
+            emitChanges(frame, theme, screen, spans);
+        }
+        std::swap(screen, shown);
+        frameBytes += frame.size();
+    };
+
+    // Warm up, then everything after this point must run without the heap
+    for (long i = 0; i < 1000; i++) {
+        step(i);
+        draw();
+    }
+    alloc_tracker::beginSteadyState(alloc_tracker::Policy::Abort);
+
+    auto start = Clock::now();
+    for (long i = 0; i < ticks; i++) step(i);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ticks;
+
+    long frames = std::max(ticks / 100, 1L);
+    start = Clock::now();
+    for (long i = 0; i < frames; i++) {
+        step(i);
+        draw();
+    }
+    double frameNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / frames;
+    alloc_tracker::endSteadyState();
+
+    std::printf("tick  %6.1f ns  (%d fruits spawned, score %d, %zu HUD bytes)\n", ns,
+                sim.spawnedCount(), sim.getScore(), hudBytes);
+    std::printf("frame %6.1f ns  (tick, compose, diff and emit; %.1f bytes/frame)\n", frameNs,
+                static_cast<double>(frameBytes) / (frames + 1000));
+#ifdef FRUIT_ALLOC_TRACK
+    alloc_tracker::report(stdout);
+#else
+    std::printf("built without FRUIT_ALLOC_TRACK, allocations not checked\n");
+#endif
+    return alloc_tracker::steadyStateAllocations() == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// Kitty graphics sprites, headless: plays a 60 fps game with the fruit as
+// a sprite, captures the byte stream the frames would write and parses its
+// graphics commands. Reports bytes for uploading once and placing by ID
+// against sending the image again whenever the sprite moves. Fails if the
+// stream uploads anything after the first frame, if a frame places the
+// sprite without it having moved, or if placing does not cost less than
+// 1% of re-sending. Also runs the capability probe against fake terminals
+// on a socket pair: one with graphics, one without, and one that never
+// answers.
+//
+//   sprite_bench [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../src/frame_diff.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+#include "../src/sprites.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+const int TICK_MS = 200;
+const int FPS = 60;
+const int CELL_HEIGHT_PX = 16;
+
+struct Commands {
+    int uploads;        // first chunk of a transmission
+    int chunks;
+    int placements;
+    int deletes;
+};
+
+// Counts the graphics commands (ESC _ G keys ; payload ESC \) in stream
+static Commands parseCommands(const std::string& stream) {
+    Commands commands{0, 0, 0, 0};
+    std::size_t at = 0;
+    while ((at = stream.find("\x1b_G", at)) != std::string::npos) {
+        std::size_t end = stream.find("\x1b\\", at);
+        std::string keys = stream.substr(at + 3, stream.find(';', at) - at - 3);
+        commands.chunks++;
+        if (keys.find("a=t") != std::string::npos) commands.uploads++;
+        if (keys.find("a=p") != std::string::npos) commands.placements++;
+        if (keys.find("a=d") != std::string::npos) commands.deletes++;
+        at = end;
+    }
+    return commands;
+}
+
+// Plays the fake terminal's side of a probe: reads the query, then sends
+// reply, or nothing when silent
+static bool probeAgainst(const char* reply, int timeoutMs, double& ms) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return false;
+    std::thread terminal([&] {
+        char buffer[256];
+        if (read(fds[1], buffer, sizeof(buffer)) > 0 && reply) {
+            if (write(fds[1], reply, std::char_traits<char>::length(reply)) < 0) return;
+        }
+    });
+    auto start = Clock::now();
+    bool supported = probeKittyGraphics(fds[0], fds[0], timeoutMs);
+    ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    terminal.join();
+    close(fds[0]);
+    close(fds[1]);
+    return supported;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 6000;
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Theme theme = Theme::dark();
+    bool ok = true;
+
+    Simulation sim(fruits, SimulationConfig{WIDTH, HEIGHT, TICK_MS, TICK_MS, 0, {}}, 7);
+    Framebuffer screen(WIDTH, HEIGHT);
+    Framebuffer shown(WIDTH, HEIGHT);
+    std::vector<Span> spans;
+    spans.reserve(WIDTH * HEIGHT);
+    SpriteLayer sprites;
+    sprites.setCellHeight(CELL_HEIGHT_PX);
+    std::string frame;
+    frame.reserve(64 * 1024);
+
+    std::string upload;
+    std::size_t uploadBytes = sprites.upload(upload, theme, static_cast<int>(fruits.size()));
+    double imageBytes = static_cast<double>(uploadBytes) / fruits.size();
+    std::string stream;
+    double placeBytes = 0;
+    double resendBytes = 0;
+    int moves = 0;
+    int framesPerTick = FPS * TICK_MS / 1000;
+    sim.spawnFruit();
+    for (int i = 0; i < frames; i++) {
+        float alpha = static_cast<float>(i % framesPerTick) / framesPerTick;
+        screen.clear();
+        drawPlayfield(screen, 0, sim, GlyphMode::Sprites, alpha);
+        frame.clear();
+        diffFrames(shown, screen, spans);
+        emitChanges(frame, theme, screen, spans);
+        std::size_t before = frame.size();
+        std::size_t placed = sprites.update(frame, fruitPlacement(0, sim, alpha));
+        std::swap(screen, shown);
+        placeBytes += placed;
+        if (placed > 0) {
+            moves++;
+            // Without IDs a moved sprite means sending the image again
+            resendBytes += imageBytes;
+            if (parseCommands(frame.substr(before)).placements == 0 && fruitPlacement(0, sim, alpha).visible) {
+                ok = false;
+            }
+        }
+        stream += frame;
+
+        if (i % framesPerTick == framesPerTick - 1) {
+            if (sim.fruitRow() == 12 && sim.spawnedCount() % 3 != 0) sim.sortInto(sim.fruitIndex());
+            sim.tick();
+            sim.spawnFruit();
+        }
+    }
+
+    Commands uploaded = parseCommands(upload);
+    Commands played = parseCommands(stream);
+    std::printf("upload once: %zu bytes for %zu sprites (%d chunks)\n", uploadBytes, fruits.size(),
+                uploaded.chunks);
+    std::printf("frames: %d, sprite moved in %d, %d placements, %d deletes, %d uploads\n", frames, moves,
+                played.placements, played.deletes, played.uploads);
+    std::printf("placing by ID: %.1f bytes/frame  re-sending images: %.0f bytes/frame  (%.3f%%)\n",
+                placeBytes / frames, resendBytes / frames, 100 * placeBytes / resendBytes);
+    if (uploaded.uploads != static_cast<int>(fruits.size()) || played.uploads != 0) ok = false;
+    if (played.placements > moves || placeBytes >= resendBytes / 100) ok = false;
+
+    double ms = 0;
+    bool graphics = probeAgainst("\x1b_Gi=31;OK\x1b\\\x1b[?62;22c", 500, ms);
+    std::printf("probe, graphics terminal: %s in %.1f ms\n", graphics ? "supported" : "unsupported", ms);
+    if (!graphics) ok = false;
+    bool plain = probeAgainst("\x1b[?62;22c", 500, ms);
+    std::printf("probe, text terminal:     %s in %.1f ms\n", plain ? "supported" : "unsupported", ms);
+    if (plain || ms > 250) ok = false;
+    bool silent = probeAgainst(nullptr, 100, ms);
+    std::printf("probe, silent:            %s in %.1f ms\n", silent ? "supported" : "unsupported", ms);
+    if (silent) ok = false;
+
+    if (!ok) std::printf("sprite check failed\n");
+    return ok ? 0 : 1;
+}
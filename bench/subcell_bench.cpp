@@ -0,0 +1,115 @@
+// Sub-cell rendering: output bytes per second for a played-out game in
+// text mode at the tick rate and in the half-block and braille modes at 60
+// frames per second between 200 ms ticks, all through the frame diff. Also
+// times encoding braille glyphs through the UTF-8 lookup table against the
+// generic encoder, and checks every dot mask round-trips through its glyph.
+//
+//   subcell_bench [ticks]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/frame_diff.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+#include "../src/subcell.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+const int TICK_MS = 200;
+const int FPS = 60;
+
+// appendUtf8 without the table, for comparison
+static void appendUtf8Generic(std::string& out, char32_t glyph) {
+    if (glyph < 0x80) {
+        out += static_cast<char>(glyph);
+    } else {
+        appendMultibyteUtf8(out, glyph);
+    }
+}
+
+int main(int argc, char** argv) {
+    int ticks = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    Theme theme = Theme::dark();
+    bool ok = true;
+
+    const std::pair<const char*, GlyphMode> modes[] = {
+        {"text", GlyphMode::Text}, {"halfblock", GlyphMode::HalfBlock}, {"braille", GlyphMode::Braille}};
+    for (auto [name, mode] : modes) {
+        Simulation sim(fruits, SimulationConfig{WIDTH, HEIGHT, TICK_MS, TICK_MS, 0, {}}, 7);
+        Framebuffer screen(WIDTH, HEIGHT + 3);
+        Framebuffer shown(WIDTH, HEIGHT + 3);
+        std::vector<Span> spans;
+        spans.reserve(WIDTH * (HEIGHT + 3));
+        std::string frame;
+        frame.reserve(64 * 1024);
+        int framesPerTick = mode == GlyphMode::Text ? 1 : FPS * TICK_MS / 1000;
+
+        double bytes = 0;
+        double drawNs = 0;
+        int frames = 0;
+        for (int tick = 0; tick < ticks; tick++) {
+            sim.spawnFruit();
+            for (int f = 0; f < framesPerTick; f++) {
+                auto start = Clock::now();
+                screen.clear();
+                drawPlayfield(screen, 0, sim, mode, static_cast<float>(f + 1) / framesPerTick);
+                frame.clear();
+                if (!diffFrames(shown, screen, spans)) ok = false;
+                bytes += emitChanges(frame, theme, screen, spans);
+                drawNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+                std::swap(screen, shown);
+                frames++;
+            }
+            if (sim.fruitRow() == 12 && tick % 3 != 0) {
+                sim.sortInto(sim.fruitIndex());
+            } else {
+                sim.tick();
+            }
+        }
+        double seconds = ticks * TICK_MS / 1000.0;
+        std::printf("%-9s %3d fps  %6.1f bytes/frame  %8.0f bytes/s  %6.0f ns/frame\n", name,
+                    framesPerTick * 1000 / TICK_MS, bytes / frames, bytes / seconds, drawNs / frames);
+    }
+
+    for (unsigned mask = 0; mask < 256; mask++) {
+        if (subcellMask(GlyphMode::Braille, subcellGlyph(GlyphMode::Braille, mask)) != mask) ok = false;
+        if (mask < 4 && subcellMask(GlyphMode::HalfBlock, subcellGlyph(GlyphMode::HalfBlock, mask)) != mask) {
+            ok = false;
+        }
+        std::string table;
+        std::string generic;
+        appendUtf8(table, subcellGlyph(GlyphMode::Braille, mask));
+        appendUtf8Generic(generic, subcellGlyph(GlyphMode::Braille, mask));
+        if (table != generic) ok = false;
+    }
+
+    std::string out;
+    out.reserve(3 * 256 * 64);
+    const int rounds = 20000;
+    double tableNs = 0;
+    double genericNs = 0;
+    for (int round = 0; round < rounds; round++) {
+        out.clear();
+        auto start = Clock::now();
+        for (unsigned mask = 0; mask < 256; mask++) appendUtf8(out, 0x2800 + mask);
+        auto middle = Clock::now();
+        out.clear();
+        for (unsigned mask = 0; mask < 256; mask++) appendUtf8Generic(out, 0x2800 + mask);
+        auto end = Clock::now();
+        tableNs += std::chrono::duration<double, std::nano>(middle - start).count();
+        genericNs += std::chrono::duration<double, std::nano>(end - middle).count();
+    }
+    std::printf("braille UTF-8: table %.2f ns/glyph, generic %.2f ns/glyph\n", tableNs / rounds / 256,
+                genericNs / rounds / 256);
+
+    if (!ok) std::printf("sub-cell check failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// Cost of Telemetry::record in a 1 kHz tick loop, its effect on tick timing,
+// heap allocations while streaming, and drop counting when the ring is too
+// small for the flush interval.
+//
+//   telemetry_bench [seconds] [path]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "../src/telemetry.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<std::size_t> heapAllocations(0);
+
+// The replacements below pair malloc/free on purpose
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct LoopStats {
+    double recordNs;
+    double meanLateUs;
+    double worstLateUs;
+};
+
+// Ticks every millisecond like a fast game loop and measures how late each
+// tick wakes up.
+static LoopStats runLoop(Telemetry& telemetry, int ticks) {
+    LoopStats stats{0, 0, 0};
+    auto next = Clock::now();
+    for (int i = 0; i < ticks; i++) {
+        next += std::chrono::milliseconds(1);
+        std::this_thread::sleep_until(next);
+        auto now = Clock::now();
+        double lateUs = std::chrono::duration<double, std::micro>(now - next).count();
+        stats.meanLateUs += lateUs;
+        if (lateUs > stats.worstLateUs) stats.worstLateUs = lateUs;
+
+        FrameSample sample{static_cast<std::uint64_t>(i), now.time_since_epoch().count(),
+                           static_cast<std::uint32_t>(lateUs * 1000), 1700,
+                           i % 7 == 0 ? 250000u : 0u, i * 10, 1};
+        auto start = Clock::now();
+        telemetry.record(sample);
+        stats.recordNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    stats.recordNs /= ticks;
+    stats.meanLateUs /= ticks;
+    return stats;
+}
+
+static void print(const char* name, const LoopStats& stats) {
+    std::printf("%-10s record %6.1f ns  tick late %6.1f us mean  %8.1f us worst\n", name,
+                stats.recordNs, stats.meanLateUs, stats.worstLateUs);
+}
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1 ? std::atoi(argv[1]) : 3) * 1000;
+    std::string path = argc > 2 ? argv[2] : "/tmp/fruit_telemetry.ndjson";
+    std::string error;
+
+    Telemetry off;
+    print("disabled", runLoop(off, ticks));
+
+    {
+        Telemetry telemetry;
+        if (!telemetry.open(path, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        // Let the writer set up its record and buffer before counting
+        runLoop(telemetry, 200);
+        std::size_t before = heapAllocations.load();
+        print("enabled", runLoop(telemetry, ticks));
+        std::size_t allocations = heapAllocations.load() - before;
+        telemetry.close();
+        std::printf("streamed %llu records, %llu dropped, %zu heap allocations while streaming\n",
+                    static_cast<unsigned long long>(telemetry.written()),
+                    static_cast<unsigned long long>(telemetry.dropped()), allocations);
+    }
+
+    {
+        // 16 slots drained every 100 ms cannot keep up with 1 kHz
+        Telemetry small(16, 100);
+        if (!small.open(path, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        print("tiny ring", runLoop(small, 1000));
+        small.close();
+        std::printf("streamed %llu records, %llu dropped\n",
+                    static_cast<unsigned long long>(small.written()),
+                    static_cast<unsigned long long>(small.dropped()));
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Bytes per frame for each theme over a played-out game, against the same
+// frames in monochrome and against a naive renderer that writes an escape
+// sequence before every cell. Fails if a colour theme needs more than twice
+// the monochrome bytes.
+//
+//   theme_bench [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../src/framebuffer.h"
+#include "../src/renderer.h"
+#include "../src/simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDTH = 80;
+const int HEIGHT = 20;
+const int HEADER_ROWS = 3;
+
+static void drawFrame(Framebuffer& screen, const Simulation& sim) {
+    screen.clear();
+    int x = screen.text(0, 0, "Score: ", Style::Status);
+    screen.text(x, 0, std::to_string(sim.getScore()), Style::Status);
+    if (sim.getScore() > 50) screen.text(0, 2, "Achievement unlocked: First Catch", Style::Achievement);
+    drawPlayfield(screen, HEADER_ROWS, sim);
+    screen.text(0, HEADER_ROWS + HEIGHT + 1,
+                "Controls: [1-4] to select basket, [P] perf overlay, [Q] to quit", Style::Controls);
+}
+
+// One escape sequence per cell, the way colour is usually bolted on.
+static std::size_t emitNaive(const Framebuffer& screen, const Theme& theme, std::string& out) {
+    for (int y = 0; y < screen.getHeight(); y++) {
+        for (int x = 0; x < screen.getWidth(); x++) {
+            out += theme.sequence(cellStyle(screen.at(x, y)));
+            appendUtf8(out, cellGlyph(screen.at(x, y)));
+        }
+        out += '\n';
+    }
+    return out.size();
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::vector<Fruit> fruits = {{"Apple", 'A'}, {"Banana", 'B'}, {"Cherry", 'C'}, {"Grape", 'G'}};
+    std::vector<Theme> themes = {Theme::monochrome(), Theme::dark(), Theme::light()};
+    std::vector<double> bytes(themes.size(), 0);
+    std::vector<double> emitNs(themes.size(), 0);
+    double naiveBytes = 0;
+
+    Simulation sim(fruits, SimulationConfig{WIDTH, HEIGHT, 200, 50, 2, {}}, 7);
+    Framebuffer screen(WIDTH, HEADER_ROWS + HEIGHT + 2);
+    std::string frame;
+    frame.reserve(64 * 1024);
+    for (int i = 0; i < frames; i++) {
+        sim.spawnFruit();
+        drawFrame(screen, sim);
+        for (std::size_t t = 0; t < themes.size(); t++) {
+            frame.clear();
+            auto start = Clock::now();
+            bytes[t] += screen.emit(frame, themes[t]);
+            emitNs[t] += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }
+        frame.clear();
+        naiveBytes += emitNaive(screen, themes[1], frame);
+        if (sim.fruitRow() == 12 && i % 3 != 0) {
+            sim.sortInto(sim.fruitIndex());
+        } else {
+            sim.tick();
+        }
+    }
+
+    bool ok = true;
+    for (std::size_t t = 0; t < themes.size(); t++) {
+        double ratio = bytes[t] / bytes[0];
+        std::printf("%-6s %7.0f bytes/frame  %.2fx mono  %7.0f ns emit\n", themes[t].name().c_str(),
+                    bytes[t] / frames, ratio, emitNs[t] / frames);
+        if (ratio > 2) ok = false;
+    }
+    std::printf("naive  %7.0f bytes/frame  %.2fx mono (escape per cell, dark)\n", naiveBytes / frames,
+                naiveBytes / bytes[0]);
+    if (!ok) std::printf("a colour theme exceeds 2x monochrome bytes\n");
+    return ok ? 0 : 1;
+}
@@ -5,146 +5,740 @@
 #include <ctime>
 #include <thread>
 #include <chrono>
+#include <memory>
+#include <algorithm>
+#include <string_view>
+#include <cstring>
 
-// Basic game constants
+#include "src/achievements.h"
+#include "src/alloc_tracker.h"
+#include "src/builtin_catalog.h"
+#include "src/catalog.h"
+#include "src/daily_challenge.h"
+#include "src/event_log.h"
+#include "src/frame_diff.h"
+#include "src/frame_writer.h"
+#include "src/framebuffer.h"
+#include "src/game_types.h"
+#include "src/leaderboard.h"
+#include "src/perf_counters.h"
+#include "src/perf_overlay.h"
+#include "src/profile_store.h"
+#include "src/profiler.h"
+#include "src/renderer.h"
+#include "src/theme.h"
+#include "src/save_data.h"
+#include "src/simulation.h"
+#include "src/sprites.h"
+#include "src/subcell.h"
+#include "src/telemetry.h"
+#include "src/terminal.h"
+#include "src/util.h"
+
+// Basic game constants. The playfield follows the terminal's size; these
+// are its size when that is unknown, and the size challenges are made for.
 const int SCREEN_WIDTH = 80;
 const int SCREEN_HEIGHT = 20;
+const int MIN_PLAYFIELD_WIDTH = 20;
+const int MIN_PLAYFIELD_HEIGHT = 5;
+// Longest stretch one frame may simulate, so a stall (a suspended
+// terminal, a debugger) does not come back as a burst of ticks
+const std::chrono::milliseconds MAX_FRAME_TIME(250);
+// Most ticks one frame may run to catch up; time beyond them is dropped
+// rather than carried, so ticks slower than frames cannot snowball
+const int MAX_TICKS_PER_FRAME = 8;
+const int CHALLENGE_WINDOW_DAYS = 7;
+const char* const SESSION_LOG_PATH = "session.wal";
+const char* const PROFILE_PATH = "profile.json";
+const char* const REPLAY_PATH = "last_replay.json";
+const char* const TRACE_PATH = "fruit_trace.json";
 
-// Game objects
-struct Fruit {
-    std::string type;
-    char symbol;
-};
+using Clock = std::chrono::steady_clock;
+
+// The simulation's tick as a loop step, never shorter than a millisecond
+// so a zero or negative tick rate cannot stall the loop.
+static Clock::duration tickStep(const Simulation& sim) {
+    return std::chrono::milliseconds(std::max(sim.tickMs(), 1));
+}
 
-struct Basket {
-    int x;
-    std::string type;
-    char symbol;
+// A frame-sized duration in nanoseconds, as the overlay and telemetry keep it.
+static std::uint32_t toNs(Clock::duration duration) {
+    return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+// Command-line settings.
+struct GameOptions {
+    bool daily = false;
+    std::string catalogPath;    // empty for the compiled-in catalog
+    std::string telemetryPath;  // empty when telemetry is off
+    int perfInterval = 0;       // frames per counter report, 0 when off
+    Theme theme = Theme::dark();
+    GlyphMode glyphs = GlyphMode::Text;
+    int fps = 60;               // frames drawn per second, independent of the tick rate
 };
 
 class Game {
 private:
     bool running;
-    int score;
+    bool daily;
+    std::string catalogPath;    // empty for the compiled-in catalog
     std::vector<Fruit> fruits;
-    std::vector<Basket> baskets;
-    Fruit* currentFruit;
-    int fruitY;
+    Catalog catalog;
+    std::unique_ptr<Simulation> sim;
+    Leaderboard leaderboard;
+    AchievementEngine achievements;
+    int lastAchievement;        // shown under the score, -1 for none
+    ChallengeCache challenges;
+    DailyChallenge challenge;
+    std::string challengeDay;   // dayString(challenge.day), formatted once
+    EventLog eventLog;
+    RecoveredSession recovered;
+    std::uint64_t seed;
+    ProfileStore profiles;
+    Profile profile;
+    Replay replay;
+    int caught;
+    int missed;
+    std::string telemetryPath;  // empty when telemetry is off
+    Telemetry telemetry;
+    Theme theme;
+    GlyphMode glyphs;
+    SpriteLayer sprites;        // the falling fruit in GlyphMode::Sprites
+    Clock::duration frameInterval;
+    int headerRows;             // status lines above the playfield
+    Framebuffer screen;         // the frame being drawn
+    Framebuffer shown;          // the frame on the terminal
+    std::vector<Span> changes;
+    bool redraw;                // next frame replaces the whole screen
+    bool paused;                // waiting for a terminal large enough to play on
+    std::string status;         // scratch for formatting status lines
+    std::string frame;          // reused for every frame
+    std::string controls;       // help line, keys for as many baskets as there are
+    std::string pausedReason;   // what needs the larger terminal
+    std::string pausedSize;     // terminal size it needs
+    FrameWriter output;         // drops frames while the terminal is backed up
+    int perfInterval;           // frames per counter report, 0 when off
+    PerfCounters perf;
+    PerfSample simulateCounts;
+    PerfSample renderCounts;
+    std::string perfReport;
+    PerfOverlay overlay;
 
     void initializeFruits() {
-        fruits = {
-            {"apple", 'A'},
-            {"banana", 'B'},
-            {"orange", 'O'},
-            {"grape", 'G'}
-        };
+        std::string error;
+        if (catalogPath.empty()) {
+            catalog = builtinCatalog();
+        } else if (!loadCatalog(catalogPath, catalog, error) ||
+                   !validateCatalog(catalog, SCREEN_WIDTH, error)) {
+            std::cerr << "Using built-in catalog: " << error << "\n";
+            catalog = builtinCatalog();
+        }
+        fruits = catalog.fruits;
+    }
+
+    // Whether the recovered session can be picked up: started with the
+    // catalog loaded now, and its counts adding up to its score
+    bool resumable(std::string& error) const {
+        if (recovered.catalog != catalogHash(catalog)) {
+            error = "it was played with a different catalog";
+            return false;
+        }
+        const Tuning& tuning = catalog.tuning;
+        std::int64_t score = static_cast<std::int64_t>(recovered.caught) * tuning.catchPoints -
+                             static_cast<std::int64_t>(recovered.missed) * tuning.missPenalty;
+        if (recovered.caught < 0 || recovered.missed < 0 || recovered.spawned < 0 ||
+            recovered.caught + static_cast<std::int64_t>(recovered.missed) > recovered.spawned ||
+            score != recovered.score) {
+            error = "its score and counts do not add up";
+            return false;
+        }
+        return true;
+    }
+
+    void initializeSimulation() {
+        int today = dayNumber(time(0));
+        std::string error;
+        if (!challenges.load(error)) std::cerr << "Daily challenges: " << error << "\n";
+        if (!EventLog::recover(SESSION_LOG_PATH, recovered, error)) {
+            std::cerr << "Session log: " << error << "\n";
+        }
+
+        if (recovered.active && !resumable(error)) {
+            std::cerr << "Not resuming interrupted session: " << error << "\n";
+            recovered.active = false;
+        }
+
+        if (recovered.active) {
+            // Pick up the interrupted session, including its challenge
+            std::cout << "Resuming interrupted session at score " << recovered.score << "\n";
+            daily = recovered.day >= 0 && challenges.find(recovered.day, challenge) &&
+                    challenge.catalog == catalogHash(catalog);
+            seed = recovered.seed;
+        } else {
+            // Today's challenge is generated here if the cache missed it;
+            // the bot plays it in microseconds
+            if (daily) challenge = challenges.get(today, catalog, SCREEN_WIDTH, SCREEN_HEIGHT);
+            seed = daily ? challenge.seed : time(0);
+        }
+        // Keep the upcoming days generated so startup rarely has to
+        challenges.prefetch(today, CHALLENGE_WINDOW_DAYS, catalog, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        const Tuning& tuning = catalog.tuning;
+        SimulationConfig config{SCREEN_WIDTH, SCREEN_HEIGHT, tuning.tickMs, tuning.tickMs, 0, {},
+                                catalog.baskets, tuning.catchPoints, tuning.missPenalty};
+        if (daily) config = challengeConfig(challenge, catalog, SCREEN_WIDTH, SCREEN_HEIGHT);
+        sim.reset(new Simulation(fruits, config, seed));
+        if (daily) {
+            challengeDay = dayString(challenge.day);
+            pausedReason = "Daily challenge paused: it is played on a ";
+            pausedSize = std::to_string(SCREEN_WIDTH) + "x" + std::to_string(headerRows + SCREEN_HEIGHT + 3) +
+                         " terminal or larger";
+        } else if (!catalog.baskets.empty()) {
+            int columns = 0;
+            for (const Basket& basket : catalog.baskets) columns = std::max(columns, basket.x + 1);
+            pausedReason = "Paused: the baskets need a terminal";
+            pausedSize = std::to_string(columns) + " columns wide or wider";
+        }
+        controls = "Controls: [1-" + std::to_string(sim->getBaskets().size()) +
+                   "] to select basket, [P] perf overlay, [Q] to quit";
+        if (recovered.active) {
+            sim->restore(recovered.score, recovered.spawned);
+            caught = recovered.caught;
+            missed = recovered.missed;
+        }
+    }
+
+    void initializeSessionLog() {
+        std::string error;
+        if (!eventLog.open(SESSION_LOG_PATH, error)) {
+            std::cerr << "Session log: " << error << "\n";
+            return;
+        }
+        eventLog.append(WalRecordType::SessionStart, -1, static_cast<int>(catalogHash(catalog)),
+                        daily ? challenge.day : -1, seed);
+        if (recovered.active) {
+            std::int64_t counts = (static_cast<std::int64_t>(recovered.caught) << 32) | recovered.missed;
+            eventLog.append(WalRecordType::Restore, -1, recovered.score, recovered.spawned, counts);
+        }
+        // The recovered session stays in the old log until these are on disk
+        if (!eventLog.start(error)) std::cerr << "Session log: " << error << "\n";
+    }
+
+    void initializeAchievements() {
+        std::vector<std::string> names;
+        for (const auto& fruit : fruits) names.push_back(fruit.type);
+        addDefaultAchievements(achievements, names);
+    }
+
+    void collectAchievements() {
+        for (int id : achievements.newlyUnlocked()) {
+            lastAchievement = id;
+        }
+        achievements.clearNewlyUnlocked();
     }
 
-    void initializeBaskets() {
-        int spacing = SCREEN_WIDTH / fruits.size();
-        for (size_t i = 0; i < fruits.size(); i++) {
-            Basket basket;
-            basket.x = i * spacing + spacing / 2;
-            basket.type = fruits[i].type;
-            basket.symbol = fruits[i].symbol;
-            baskets.push_back(basket);
+    void handleEvent(SimEvent event, int fruit) {
+        if (event != SimEvent::None) {
+            if (replay.events.size() == replay.events.capacity()) {
+                // A session can outlast any reserve: at most one event per
+                // tick, so 16384 at a 200 ms tick take under an hour. The
+                // replay then doubles, a handful of allocations a session,
+                // made outside the checked phases on purpose
+                alloc_tracker::PhaseScope growing(nullptr);
+                replay.events.reserve(replay.events.capacity() * 2);
+            }
+            replay.events.push_back(ReplayEvent{event, fruit, sim->getScore()});
+        }
+        if (event == SimEvent::Caught) {
+            caught++;
+            achievements.onCatch(fruit);
+            eventLog.append(WalRecordType::Caught, fruit, sim->getScore());
+        } else if (event == SimEvent::WrongBasket) {
+            missed++;
+            achievements.onMiss();
+            eventLog.append(WalRecordType::WrongBasket, fruit, sim->getScore());
+        } else if (event == SimEvent::Dropped) {
+            missed++;
+            achievements.onMiss();
+            eventLog.append(WalRecordType::Dropped, fruit, sim->getScore());
         }
+        if (event != SimEvent::None) achievements.onScore(sim->getScore());
     }
 
     void spawnFruit() {
-        if (!currentFruit) {
-            currentFruit = new Fruit(fruits[rand() % fruits.size()]);
-            fruitY = 0;
+        PROFILE_ZONE("spawn");
+        int spawned = sim->spawnedCount();
+        if (!daily || spawned < challenge.fruitCount) sim->spawnFruit();
+        if (sim->spawnedCount() != spawned) {
+            eventLog.append(WalRecordType::Spawn, sim->fruitIndex(), sim->getScore(),
+                            sim->spawnedCount());
         }
     }
 
-    void drawGame() {
-        system("clear"); // Use "cls" for Windows
-        
-        // Draw score
-        std::cout << "Score: " << score << "\n\n";
+    bool challengeFinished() const {
+        return daily && !sim->fruit() && sim->spawnedCount() >= challenge.fruitCount;
+    }
 
-        // Draw game area
-        for (int y = 0; y < SCREEN_HEIGHT; y++) {
-            for (int x = 0; x < SCREEN_WIDTH; x++) {
-                if (currentFruit && y == fruitY && x == SCREEN_WIDTH/2) {
-                    std::cout << currentFruit->symbol;
-                } else if (y == SCREEN_HEIGHT-1) {
-                    bool isBasket = false;
-                    for (const auto& basket : baskets) {
-                        if (x == basket.x) {
-                            std::cout << basket.symbol;
-                            isBasket = true;
-                            break;
-                        }
-                    }
-                    if (!isBasket) std::cout << "-";
-                } else {
-                    std::cout << " ";
+    // Writes the profiler zones recorded so far; a no-op unless built with
+    // PROFILE=1.
+    void exportTrace() {
+#ifdef FRUIT_PROFILE
+        std::string error;
+        if (!profiler::exportTrace(TRACE_PATH, error)) std::cerr << "Trace: " << error << "\n";
+#endif
+    }
+
+    void initializePerfCounters() {
+        if (perfInterval <= 0) return;
+        std::string error;
+        if (!perf.open(error)) std::cerr << "Perf counters: " << error << "\n";
+    }
+
+    // Replaces the report shown under the score every perfInterval frames.
+    void reportPerfCounters(std::uint64_t frames) {
+        if (!perf.isOpen() || frames % perfInterval != 0) return;
+        perfReport.clear();
+        appendPerfPhase(perfReport, "simulate", simulateCounts);
+        perfReport += '\n';
+        appendPerfPhase(perfReport, "render", renderCounts);
+        perfReport += '\n';
+        simulateCounts = PerfSample();
+        renderCounts = PerfSample();
+    }
+
+    void initializeTelemetry() {
+        if (telemetryPath.empty()) return;
+        std::string error;
+        if (!telemetry.open(telemetryPath, error)) std::cerr << "Telemetry: " << error << "\n";
+    }
+
+    // Draws the playfield alpha of the way from the previous tick to the
+    // current one. Returns the number of bytes written for the frame.
+    std::size_t drawGame(float alpha) {
+        // The frame is drawn into cells, and only the cells that differ
+        // from the frame on the terminal are emitted, in one buffer
+        // written at once
+        screen.clear();
+        if (paused) {
+            screen.text(0, 0, pausedReason, Style::Status);
+            screen.text(0, 1, pausedSize, Style::Status);
+        } else {
+            composeGame(alpha);
+        }
+
+        frame.clear();
+        beginSynchronizedUpdate(frame);
+        std::size_t header = frame.size();
+        if (redraw || !diffFrames(shown, screen, changes)) {
+            // Drawn over the old frame rather than after clearing, so no
+            // blank screen shows between the two
+            frame += "\x1b[H";
+            screen.emit(frame, theme, true);
+            redraw = false;
+            if (glyphs == GlyphMode::Sprites) {
+                if (!sprites.isUploaded()) {
+                    sprites.upload(frame, theme, static_cast<int>(sim->getFruits().size()));
                 }
+                sprites.invalidate();
             }
-            std::cout << "\n";
+        } else {
+            emitChanges(frame, theme, screen, changes);
+        }
+        if (glyphs == GlyphMode::Sprites) {
+            sprites.update(frame, paused ? FruitPlacement{false, 0, 0, 0} : fruitPlacement(headerRows, *sim, alpha));
         }
+        std::swap(screen, shown);
+        // Frames between ticks often change nothing
+        if (frame.size() == header) return 0;
+        endSynchronizedUpdate(frame);
+        output.send(frame);
+        return frame.size();
+    }
+
+    // The header, the playfield and the controls
+    void composeGame(float alpha) {
+        // Draw score
+        status.clear();
+        status += "Score: ";
+        appendNumber(status, sim->getScore());
+        int x = screen.text(0, 0, status, Style::Status);
+        screen.text(x, 0, overlay.format(), Style::Hud);
+        if (daily) {
+            status.clear();
+            status += "Daily challenge ";
+            status += challengeDay;
+            status += ": ";
+            appendNumber(status, challenge.targetScore);
+            status += " points, fruit ";
+            appendNumber(status, sim->spawnedCount());
+            status += '/';
+            appendNumber(status, challenge.fruitCount);
+            screen.text(0, 1, status, Style::Status);
+        }
+        x = 0;
+        if (lastAchievement >= 0) {
+            x = screen.text(0, 2, "Achievement unlocked: ", Style::Achievement);
+            x = screen.text(x, 2, achievements.definition(lastAchievement).name, Style::Achievement);
+        }
+        // The overlay's second line goes on the first row it fits after
+        if (daily) {
+            screen.text(x, 2, overlay.formatLoad(), Style::Hud);
+        } else {
+            screen.text(0, 1, overlay.formatLoad(), Style::Hud);
+        }
+        std::string_view report = perfReport;
+        for (int row = 3; row < headerRows && !report.empty(); row++) {
+            std::size_t end = std::min(report.find('\n'), report.size());
+            screen.text(0, row, report.substr(0, end), Style::Hud);
+            report.remove_prefix(std::min(end + 1, report.size()));
+        }
+
+        // Draw game area
+        drawPlayfield(screen, headerRows, *sim, glyphs, alpha);
 
         // Draw controls
-        std::cout << "\nControls: [1-4] to select basket, [Q] to quit\n";
+        screen.text(0, headerRows + sim->getConfig().height + 1,
+                    controls, Style::Controls);
+    }
+
+    // Sprites need the kitty graphics protocol; anything else gets text
+    void initializeSprites() {
+        if (glyphs != GlyphMode::Sprites || probeKittyGraphics(0, 1, 200)) return;
+        std::cerr << "Terminal has no graphics protocol, drawing fruit as text\n";
+        glyphs = GlyphMode::Text;
+    }
+
+    // Fits the playfield to the terminal: the header, the playfield, a
+    // blank row and the controls, plus a spare row so the newline after
+    // the last row never scrolls. Growing the framebuffers is the only
+    // allocation the loop may make, so it happens outside any phase.
+    void applyTerminalSize() {
+        int columns, rows;
+        if (!terminalSize(columns, rows)) return;
+        int cellWidth, cellHeight;
+        if (cellPixelSize(cellWidth, cellHeight)) sprites.setCellHeight(cellHeight);
+        alloc_tracker::PhaseScope outsidePhases(nullptr);
+        if (daily) {
+            // The challenge was generated and checked by the bot at its own
+            // size, so the playfield keeps it: larger terminals leave the
+            // rest blank, smaller ones pause the game until resized
+            int frameHeight = headerRows + SCREEN_HEIGHT + 2;
+            paused = columns < SCREEN_WIDTH || rows < frameHeight + 1;
+            int width = paused ? columns : SCREEN_WIDTH;
+            int height = paused ? std::max(rows - 1, 2) : frameHeight;
+            screen.resize(width, height);
+            shown.resize(width, height);
+            changes.reserve(static_cast<std::size_t>(width / 2) * height);
+            redraw = true;
+            return;
+        }
+        int width = std::max(columns, MIN_PLAYFIELD_WIDTH);
+        int height = std::max(rows - headerRows - 3, MIN_PLAYFIELD_HEIGHT);
+        // Fixed baskets cannot move to fit: on a terminal too narrow for
+        // them they would pile up on the last column, so the game pauses
+        std::string error;
+        paused = !catalog.baskets.empty() && !validateCatalog(catalog, width, error);
+        if (paused) {
+            screen.resize(columns, std::max(rows - 1, 2));
+            shown.resize(columns, std::max(rows - 1, 2));
+            changes.reserve(static_cast<std::size_t>(columns / 2) * screen.getHeight());
+            redraw = true;
+            return;
+        }
+        sim->resize(width, height);
+        screen.resize(width, headerRows + height + 2);
+        shown.resize(width, headerRows + height + 2);
+        changes.reserve(static_cast<std::size_t>(width / 2) * screen.getHeight());
+        redraw = true;
+    }
+
+    void recordScore() {
+        std::string error;
+        if (!leaderboard.open(error)) {
+            std::cerr << "Leaderboard unavailable: " << error << "\n";
+            return;
+        }
+        ScoreEntry entry{};
+        entry.score = sim->getScore();
+        entry.timestamp = time(0);
+        setPlayerName(entry, "player");
+        leaderboard.submit(entry);
+
+        std::cout << "Leaderboard rank: #" << leaderboard.rankOf(entry.score)
+                  << " of " << leaderboard.size() << "\n";
+    }
+
+    void loadProgress() {
+        std::string error;
+        if (!profiles.load(profile, error)) std::cerr << "Profile: " << error << "\n";
+
+        // Lifetime achievements count from the saved totals, plus what a
+        // resumed session had already caught and missed
+        for (std::size_t id = 0; id < achievements.count(); id++) {
+            const std::string& name = achievements.definition(id).name;
+            if (std::find(profile.achievements.begin(), profile.achievements.end(), name) !=
+                profile.achievements.end()) {
+                achievements.restoreUnlocked(id);
+            }
+        }
+        achievements.restore(profile.totalCaught + caught, profile.totalMissed + missed,
+                             std::max<std::int64_t>(profile.bestScore, sim->getScore()));
+    }
+
+    void saveProgress(std::int64_t startTime) {
+        std::string error;
+        SessionRecord session{};
+        session.timestamp = startTime;
+        session.score = sim->getScore();
+        session.caught = caught;
+        session.missed = missed;
+        session.durationMs = static_cast<std::int32_t>((time(0) - startTime) * 1000);
+        session.mode = daily ? GameMode::Challenge : GameMode::Classic;
+
+        profile.gamesPlayed++;
+        profile.bestScore = std::max<std::int64_t>(profile.bestScore, session.score);
+        profile.totalCaught += caught;
+        profile.totalMissed += missed;
+        profile.history.push_back(session);
+        for (std::size_t id = 0; id < achievements.count(); id++) {
+            const std::string& name = achievements.definition(id).name;
+            if (achievements.isUnlocked(id) &&
+                std::find(profile.achievements.begin(), profile.achievements.end(), name) ==
+                    profile.achievements.end()) {
+                profile.achievements.push_back(name);
+            }
+        }
+
+        // Only the change since the last save is written
+        if (!profiles.save(profile, error) || !saveReplay(REPLAY_PATH, replay, error)) {
+            std::cerr << "Save failed: " << error << "\n";
+        }
     }
 
 public:
-    Game() : running(true), score(0), currentFruit(nullptr), fruitY(0) {
+    explicit Game(const GameOptions& options)
+        : running(true), daily(options.daily), catalogPath(options.catalogPath),
+          leaderboard("leaderboard.dat"), lastAchievement(-1), challenges("daily_challenges.json"),
+          seed(0), profiles(PROFILE_PATH), caught(0), missed(0),
+          telemetryPath(options.telemetryPath), theme(options.theme), glyphs(options.glyphs),
+          frameInterval(std::chrono::nanoseconds(1000000000 / std::max(options.fps, 1))),
+          headerRows(options.perfInterval > 0 ? 5 : 3),
+          screen(SCREEN_WIDTH, headerRows + SCREEN_HEIGHT + 2),
+          shown(SCREEN_WIDTH, headerRows + SCREEN_HEIGHT + 2), redraw(true), paused(false),
+          perfInterval(options.perfInterval), overlay(alloc_tracker::TRACKING) {
         initializeFruits();
-        initializeBaskets();
+        initializeSimulation();
+        initializeSessionLog();
+        initializeAchievements();
+        initializeTelemetry();
+        initializePerfCounters();
+        initializeSprites();
+        loadProgress();
+        watchResize();
+        replay = Replay{seed, daily ? challenge.day : -1, {}};
+        // Sized up front so the loop itself never allocates: the replay
+        // grows only past this many events (see handleEvent), the frame and
+        // reports never do
+        replay.events.reserve(1 << 14);
+        frame.reserve(64 * 1024);
+        changes.reserve(static_cast<std::size_t>(SCREEN_WIDTH / 2) * screen.getHeight());
+        status.reserve(SCREEN_WIDTH);
+        perfReport.reserve(256);
     }
 
     void run() {
+        std::int64_t startTime = time(0);
+        std::uint64_t frames = 0;
+        Clock::time_point inputAt;      // key read not yet shown on screen
+        Clock::time_point lastFrameStart;
+        bool inputPending = false;
+        // Game time not yet simulated. Ticks run at the simulation's own
+        // rate whatever the frame rate; each frame draws the fruit
+        // accumulator / step of the way from its last tick to the next.
+        Clock::duration accumulator(0);
+        enterSession(200);
+        output.open(1);
+        Clock::time_point runStart = Clock::now();
+        spawnFruit();
         while (running) {
-            spawnFruit();
-            drawGame();
+            ALLOC_PHASE("frame");
+            Clock::time_point frameStart = Clock::now();
+            std::uint64_t frameAllocations = alloc_tracker::threadAllocations();
+            if (frames > 0) accumulator += std::min<Clock::duration>(frameStart - lastFrameStart, MAX_FRAME_TIME);
+            // Input and update count as simulate, draw as render
+            PerfSample simulateStart = perf.read();
+            if (takeResize()) {
+                PROFILE_ZONE("resize");
+                applyTerminalSize();
+            }
+            // A paused game does not run the clock
+            if (paused) accumulator = Clock::duration(0);
 
             // Handle input
-            if (_kbhit()) {
-                char input = _getch();
-                if (input >= '1' && input <= '4') {
-                    int basketIndex = input - '1';
-                    if (basketIndex < baskets.size()) {
-                        if (currentFruit->type == baskets[basketIndex].type) {
-                            score += 10;
-                        } else {
-                            score -= 5;
-                        }
-                        delete currentFruit;
-                        currentFruit = nullptr;
+            {
+                PROFILE_ZONE("input");
+                ALLOC_PHASE("input");
+                if (keyPressed()) {
+                    int input = readKey();
+                    inputAt = Clock::now();
+                    inputPending = true;
+                    int baskets = static_cast<int>(sim->getBaskets().size());
+                    if (!paused && input >= '1' && input < '1' + baskets) {
+                        int fruit = sim->fruitIndex();
+                        handleEvent(sim->sortInto(input - '1'), fruit);
+                    } else if (input == 'p' || input == 'P') {
+                        overlay.toggle();
+                    } else if (input == 't' || input == 'T') {
+                        exportTrace();
+                    } else if (input == 'q' || input == 'Q') {
+                        running = false;
                     }
-                } else if (input == 'q' || input == 'Q') {
-                    running = false;
                 }
             }
 
-            // Update fruit position
-            if (currentFruit) {
-                fruitY++;
-                if (fruitY >= SCREEN_HEIGHT-1) {
-                    delete currentFruit;
-                    currentFruit = nullptr;
-                    score -= 5;
+            // Fixed-step update; a fruit sorted or dropped is replaced
+            // after its tick, as the tick-per-frame loop did
+            Clock::duration step = tickStep(*sim);
+            Clock::time_point updateStart = Clock::now();
+            {
+                PROFILE_ZONE("update");
+                ALLOC_PHASE("update");
+                for (int ticks = 0; running && accumulator >= step; ticks++) {
+                    if (ticks == MAX_TICKS_PER_FRAME) {
+                        accumulator %= step;
+                        break;
+                    }
+                    accumulator -= step;
+                    int fruit = sim->fruitIndex();
+                    handleEvent(sim->tick(), fruit);
+                    collectAchievements();
+                    if (challengeFinished()) running = false;
+                    spawnFruit();
+                    step = tickStep(*sim);
                 }
             }
 
-            // Game speed
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            Clock::time_point drawStart = Clock::now();
+            PerfSample renderStart = perf.read();
+            std::size_t renderBytes = 0;
+            // While the terminal has not taken the last frame, this one is
+            // not drawn at all; the next one sent carries its changes
+            bool dropped = !output.beginFrame();
+            // A failed write left part of a frame on the terminal
+            if (output.takeRedraw()) redraw = true;
+            if (!dropped) {
+                PROFILE_ZONE("draw");
+                ALLOC_PHASE("draw");
+                renderBytes = drawGame(std::chrono::duration<float>(accumulator) /
+                                       std::chrono::duration<float>(step));
+            }
+            PerfSample renderEnd = perf.read();
+            Clock::time_point drawEnd = Clock::now();
+            std::uint32_t inputLatencyNs = 0;
+            if (inputPending && !dropped) {
+                inputLatencyNs = toNs(Clock::now() - inputAt);
+                inputPending = false;
+            }
+            if (perf.isOpen()) {
+                simulateCounts += renderStart - simulateStart;
+                renderCounts += renderEnd - renderStart;
+            }
+
+            std::uint32_t frameNs = toNs(Clock::now() - frameStart);
+            std::uint32_t frameIntervalNs = frames == 0 ? 0 : toNs(frameStart - lastFrameStart);
+            lastFrameStart = frameStart;
+            overlay.recordFrame(OverlayFrame{
+                frameIntervalNs, toNs(drawStart - updateStart), toNs(drawEnd - drawStart),
+                static_cast<std::uint32_t>(renderBytes), inputLatencyNs,
+                static_cast<std::uint32_t>(sim->getBaskets().size() + (sim->fruit() ? 1 : 0)),
+                static_cast<std::uint32_t>(alloc_tracker::threadAllocations() - frameAllocations), dropped});
+            if (telemetry.isOpen()) {
+                telemetry.record(FrameSample{
+                    frames, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                frameStart.time_since_epoch()).count(),
+                    frameNs, static_cast<std::uint32_t>(renderBytes), inputLatencyNs, sim->getScore(),
+                    static_cast<std::uint16_t>(sim->fruit() ? 1 : 0),
+                    static_cast<std::uint16_t>(dropped ? 1 : 0)});
+            }
+            frames++;
+            reportPerfCounters(frames);
+            // Everything the loop needs exists after the first frame
+            if (frames == 1) {
+                alloc_tracker::beginSteadyState(std::getenv("FRUIT_ALLOC_ABORT")
+                                                    ? alloc_tracker::Policy::Abort
+                                                    : alloc_tracker::Policy::Log);
+            }
+
+            PROFILE_ZONE("sleep");
+            ALLOC_PHASE("sleep");
+            std::this_thread::sleep_until(frameStart + frameInterval);
         }
+        alloc_tracker::endSteadyState();
+        double runSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+        output.close();
 
-        std::cout << "\nGame Over! Final Score: " << score << "\n";
-    }
+        if (sprites.isUploaded()) {
+            frame.clear();
+            sprites.release(frame);
+            std::cout.write(frame.data(), frame.size());
+        }
+        // Back on the normal screen, below whatever was there before
+        leaveSession();
+        std::cout << "\nGame Over! Final Score: " << sim->getScore() << "\n";
+        if (challengeFinished()) {
+            std::cout << (sim->getScore() >= challenge.targetScore ? "Daily challenge complete!\n"
+                                                                    : "Daily challenge failed.\n");
+        }
+        recordScore();
+        saveProgress(startTime);
 
-    ~Game() {
-        delete currentFruit;
+        eventLog.append(WalRecordType::SessionEnd, -1, sim->getScore());
+        eventLog.close();
+        telemetry.close();
+        exportTrace();
+        if (telemetry.dropped() > 0) {
+            std::cerr << "Telemetry: dropped " << telemetry.dropped() << " samples\n";
+        }
+        if (output.dropped() > 0) {
+            std::cerr << "Output: dropped " << output.dropped() << " of " << frames << " frames, "
+                      << (frames - output.dropped()) / runSeconds << " frames/s effective\n";
+        }
+        if (output.failed() > 0) {
+            std::cerr << "Output: " << output.failed() << " writes failed, the last with "
+                      << std::strerror(output.lastError()) << "\n";
+        }
+#ifdef FRUIT_ALLOC_TRACK
+        alloc_tracker::report(stderr);
+#endif
     }
 };
 
-int main() {
-    srand(time(0));
-    Game game;
+int main(int argc, char** argv) {
+    GameOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--daily") {
+            options.daily = true;
+        } else if (arg == "--catalog" && i + 1 < argc) {
+            options.catalogPath = argv[++i];
+        } else if (arg == "--telemetry" && i + 1 < argc) {
+            options.telemetryPath = argv[++i];
+        } else if (arg == "--perf" && i + 1 < argc) {
+            options.perfInterval = std::atoi(argv[++i]);
+        } else if (arg == "--theme" && i + 1 < argc) {
+            if (!Theme::byName(argv[++i], options.theme)) {
+                std::cerr << "Unknown theme " << argv[i] << ", expected mono, dark or light\n";
+            }
+        } else if (arg == "--glyphs" && i + 1 < argc) {
+            if (!glyphModeByName(argv[++i], options.glyphs)) {
+                std::cerr << "Unknown glyph mode " << argv[i]
+                          << ", expected text, halfblock, braille or sprites\n";
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            options.fps = std::atoi(argv[++i]);
+        }
+    }
+    Game game(options);
     game.run();
     return 0;
-}
\ No newline at end of file
+}
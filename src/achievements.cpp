@@ -0,0 +1,106 @@
+#include "achievements.h"
+
+#include <algorithm>
+
+AchievementEngine::AchievementEngine()
+    : catches{0, 0, {}}, misses{0, 0, {}}, streak{0, 0, {}}, score{0, 0, {}},
+      currentStreak(0) {}
+
+AchievementEngine::Metric& AchievementEngine::metricFor(const AchievementDef& def) {
+    switch (def.trigger) {
+        case AchievementTrigger::Misses: return misses;
+        case AchievementTrigger::Streak: return streak;
+        case AchievementTrigger::Score: return score;
+        case AchievementTrigger::FruitCatches:
+            if (def.fruit >= static_cast<int>(fruitCatches.size())) {
+                fruitCatches.resize(def.fruit + 1, Metric{0, 0, {}});
+            }
+            return fruitCatches[def.fruit];
+        default: return catches;
+    }
+}
+
+int AchievementEngine::define(const AchievementDef& def) {
+    if (def.trigger == AchievementTrigger::FruitCatches && def.fruit < 0) return -1;
+    int id = static_cast<int>(defs.size());
+    defs.push_back(def);
+    if (unlockedBits.size() * 64 < defs.size()) unlockedBits.push_back(0);
+    // Each achievement unlocks at most once, so unlocking never reallocates
+    unlockedQueue.reserve(defs.size());
+
+    Metric& metric = metricFor(def);
+    Rung rung{def.threshold, id};
+    auto pos = std::upper_bound(metric.ladder.begin(), metric.ladder.end(), rung,
+                                [](const Rung& a, const Rung& b) { return a.threshold < b.threshold; });
+    std::size_t index = pos - metric.ladder.begin();
+    metric.ladder.insert(pos, rung);
+
+    if (index < metric.next) {
+        // Inserted below the cursor: its threshold is already reached
+        metric.next++;
+        unlock(id);
+    } else {
+        raise(metric, metric.value);
+    }
+    return id;
+}
+
+void AchievementEngine::restore(std::int64_t totalCatches, std::int64_t totalMisses, std::int64_t bestScore) {
+    std::size_t queued = unlockedQueue.size();
+    raise(catches, std::max(catches.value, totalCatches));
+    raise(misses, std::max(misses.value, totalMisses));
+    raise(score, std::max(score.value, bestScore));
+    unlockedQueue.resize(queued);
+}
+
+void AchievementEngine::restoreUnlocked(int id) {
+    unlockedBits[id >> 6] |= std::uint64_t(1) << (id & 63);
+}
+
+void AchievementEngine::raise(Metric& metric, std::int64_t value) {
+    metric.value = value;
+    while (metric.next < metric.ladder.size() && metric.ladder[metric.next].threshold <= value) {
+        unlock(metric.ladder[metric.next++].id);
+    }
+}
+
+void AchievementEngine::unlock(int id) {
+    // Restored achievements are already set when their rung is reached
+    if (isUnlocked(id)) return;
+    unlockedBits[id >> 6] |= std::uint64_t(1) << (id & 63);
+    unlockedQueue.push_back(id);
+}
+
+void AchievementEngine::onCatch(int fruit) {
+    raise(catches, catches.value + 1);
+    currentStreak++;
+    if (currentStreak > streak.value) raise(streak, currentStreak);
+    if (fruit >= 0 && fruit < static_cast<int>(fruitCatches.size())) {
+        Metric& metric = fruitCatches[fruit];
+        raise(metric, metric.value + 1);
+    }
+}
+
+void AchievementEngine::onMiss() {
+    raise(misses, misses.value + 1);
+    currentStreak = 0;
+}
+
+void AchievementEngine::onScore(std::int64_t value) {
+    if (value > score.value) raise(score, value);
+}
+
+void addDefaultAchievements(AchievementEngine& engine, const std::vector<std::string>& fruitNames) {
+    engine.define({"First Catch", AchievementTrigger::Catches, 1, -1});
+    engine.define({"Fruit Fan", AchievementTrigger::Catches, 50, -1});
+    engine.define({"Orchard Keeper", AchievementTrigger::Catches, 500, -1});
+    engine.define({"On a Roll", AchievementTrigger::Streak, 5, -1});
+    engine.define({"Unstoppable", AchievementTrigger::Streak, 20, -1});
+    engine.define({"Century", AchievementTrigger::Score, 100, -1});
+    engine.define({"High Roller", AchievementTrigger::Score, 500, -1});
+    engine.define({"Butterfingers", AchievementTrigger::Misses, 10, -1});
+    for (std::size_t i = 0; i < fruitNames.size(); i++) {
+        engine.define({fruitNames[i] + " Picker", AchievementTrigger::FruitCatches, 10,
+                       static_cast<int>(i)});
+    }
+}
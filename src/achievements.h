@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What an achievement counts. Each trigger is one running metric; gameplay
+// events only touch the metrics they affect.
+enum class AchievementTrigger : std::uint8_t {
+    Catches,        // total correct catches
+    Misses,         // fruits dropped or sorted into the wrong basket
+    Streak,         // best run of consecutive catches
+    Score,          // best score reached
+    FruitCatches    // correct catches of one fruit type
+};
+
+struct AchievementDef {
+    std::string name;
+    AchievementTrigger trigger;
+    std::int64_t threshold;
+    int fruit;      // fruit index for FruitCatches, ignored otherwise
+};
+
+// Incremental achievement evaluation. Achievements subscribing to a metric
+// are kept in a ladder sorted by threshold with a cursor at the next one to
+// unlock, so an event costs O(1) plus the achievements it actually unlocks,
+// independent of how many are defined. Unlocked flags are a bitset.
+class AchievementEngine {
+private:
+    struct Rung {
+        std::int64_t threshold;
+        int id;
+    };
+
+    struct Metric {
+        std::int64_t value;
+        std::size_t next;           // first rung not yet unlocked
+        std::vector<Rung> ladder;   // sorted by threshold
+    };
+
+    std::vector<AchievementDef> defs;
+    std::vector<std::uint64_t> unlockedBits;
+    std::vector<int> unlockedQueue;
+    Metric catches;
+    Metric misses;
+    Metric streak;
+    Metric score;
+    std::vector<Metric> fruitCatches;
+    std::int64_t currentStreak;
+
+    Metric& metricFor(const AchievementDef& def);
+    void raise(Metric& metric, std::int64_t value);
+    void unlock(int id);
+
+public:
+    AchievementEngine();
+
+    // Returns the achievement id. Achievements whose threshold has already
+    // been reached unlock immediately. A FruitCatches achievement without a
+    // fruit index is not defined and returns -1.
+    int define(const AchievementDef& def);
+
+    // Picks up where a saved profile left off, once everything is defined
+    // and before play starts: the catch and miss counts continue from the
+    // lifetime totals and the best score from bestScore, and restoreUnlocked
+    // keeps an achievement earned earlier unlocked. Neither reports anything
+    // as newly unlocked. Streaks and per-fruit catches are per session.
+    void restore(std::int64_t totalCatches, std::int64_t totalMisses, std::int64_t bestScore);
+    void restoreUnlocked(int id);
+
+    void onCatch(int fruit);
+    void onMiss();
+    void onScore(std::int64_t value);
+
+    bool isUnlocked(int id) const {
+        return (unlockedBits[id >> 6] >> (id & 63)) & 1;
+    }
+    const AchievementDef& definition(int id) const { return defs[id]; }
+    std::size_t count() const { return defs.size(); }
+
+    // Ids unlocked since the last call, in unlock order.
+    const std::vector<int>& newlyUnlocked() const { return unlockedQueue; }
+    void clearNewlyUnlocked() { unlockedQueue.clear(); }
+};
+
+// The stock achievement list; fruitNames gives the per-fruit achievements.
+void addDefaultAchievements(AchievementEngine& engine, const std::vector<std::string>& fruitNames);
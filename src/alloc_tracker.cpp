@@ -0,0 +1,180 @@
+#include "alloc_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace alloc_tracker {
+
+namespace {
+
+struct Slot {
+    std::atomic<const char*> name;
+    std::atomic<std::uint64_t> allocations;
+    std::atomic<std::uint64_t> bytes;
+};
+
+// Slot 0 collects allocations made outside any phase. Everything here is
+// statically allocated: the tracker must never allocate itself.
+Slot slots[MAX_PHASES];
+std::atomic<std::size_t> slotCount(1);
+std::mutex slotMutex;
+
+std::atomic<bool> steadyState(false);
+std::atomic<Policy> steadyPolicy(Policy::Log);
+std::atomic<std::uint64_t> steadyAllocations(0);
+
+thread_local const char* currentPhase = nullptr;
+thread_local std::size_t currentSlot = 0;
+thread_local std::uint64_t threadCount = 0;
+
+std::size_t slotFor(const char* name) {
+    if (!name) return 0;
+    std::size_t count = slotCount.load(std::memory_order_acquire);
+    for (std::size_t i = 1; i < count; i++) {
+        const char* existing = slots[i].name.load(std::memory_order_relaxed);
+        if (existing == name || std::strcmp(existing, name) == 0) return i;
+    }
+    std::lock_guard<std::mutex> lock(slotMutex);
+    count = slotCount.load(std::memory_order_relaxed);
+    for (std::size_t i = 1; i < count; i++) {
+        if (std::strcmp(slots[i].name.load(std::memory_order_relaxed), name) == 0) return i;
+    }
+    // Past MAX_PHASES new phases share the last slot
+    if (count == MAX_PHASES) return MAX_PHASES - 1;
+    slots[count].name.store(name, std::memory_order_relaxed);
+    slotCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+}  // namespace
+
+const char* setPhase(const char* name) {
+    const char* previous = currentPhase;
+    currentPhase = name;
+    currentSlot = slotFor(name);
+    return previous;
+}
+
+void beginSteadyState(Policy policy) {
+    steadyPolicy.store(policy, std::memory_order_relaxed);
+    steadyAllocations.store(0, std::memory_order_relaxed);
+    steadyState.store(true, std::memory_order_release);
+}
+
+void endSteadyState() {
+    steadyState.store(false, std::memory_order_release);
+}
+
+std::uint64_t steadyStateAllocations() {
+    return steadyAllocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t threadAllocations() {
+    return threadCount;
+}
+
+std::size_t phaseStats(PhaseStats* out) {
+    std::size_t count = slotCount.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; i++) {
+        const char* name = slots[i].name.load(std::memory_order_relaxed);
+        out[i] = PhaseStats{name ? name : "(none)", slots[i].allocations.load(std::memory_order_relaxed),
+                            slots[i].bytes.load(std::memory_order_relaxed)};
+    }
+    return count;
+}
+
+void report(std::FILE* out) {
+    PhaseStats stats[MAX_PHASES];
+    std::size_t count = phaseStats(stats);
+    std::fprintf(out, "heap allocations by phase:\n");
+    for (std::size_t i = 0; i < count; i++) {
+        std::fprintf(out, "  %-12s %10llu allocations %12llu bytes\n", stats[i].name,
+                     static_cast<unsigned long long>(stats[i].allocations),
+                     static_cast<unsigned long long>(stats[i].bytes));
+    }
+    std::fprintf(out, "  steady state: %llu allocations\n",
+                 static_cast<unsigned long long>(steadyStateAllocations()));
+}
+
+#ifdef FRUIT_ALLOC_TRACK
+
+namespace {
+
+void record(std::size_t size) {
+    threadCount++;
+    Slot& slot = slots[currentSlot];
+    slot.allocations.fetch_add(1, std::memory_order_relaxed);
+    slot.bytes.fetch_add(size, std::memory_order_relaxed);
+    if (currentPhase && steadyState.load(std::memory_order_relaxed)) {
+        steadyAllocations.fetch_add(1, std::memory_order_relaxed);
+        // stdio allocates with malloc, not operator new, so this cannot recurse
+        std::fprintf(stderr, "steady-state allocation of %zu bytes in phase %s\n", size, currentPhase);
+        if (steadyPolicy.load(std::memory_order_relaxed) == Policy::Abort) std::abort();
+    }
+}
+
+void* allocate(std::size_t size) {
+    record(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    record(size);
+    void* p = nullptr;
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+    return posix_memalign(&p, align, size ? size : 1) == 0 ? p : nullptr;
+}
+
+}  // namespace
+
+#endif  // FRUIT_ALLOC_TRACK
+
+}  // namespace alloc_tracker
+
+#ifdef FRUIT_ALLOC_TRACK
+
+// The replacements pair malloc/posix_memalign with free on purpose
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    if (void* p = alloc_tracker::allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = alloc_tracker::allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracker::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracker::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = alloc_tracker::allocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* p = alloc_tracker::allocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#endif  // FRUIT_ALLOC_TRACK
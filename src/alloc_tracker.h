@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Heap allocation tracking build mode (make ALLOC_TRACK=1, which defines
+// FRUIT_ALLOC_TRACK). alloc_tracker.cpp then replaces the global operator
+// new and delete, counts every allocation against the calling thread's
+// current phase, and checks steady state: once beginSteadyState() is called,
+// an allocation made inside any phase is logged or aborts the process.
+// Threads that never enter a phase (background writers, loaders) are
+// counted but never checked.
+//
+//   ALLOC_PHASE("draw");
+//   drawGame();
+//
+// Without FRUIT_ALLOC_TRACK the operators are not replaced and ALLOC_PHASE
+// expands to nothing; the functions below still link and report zeros.
+
+namespace alloc_tracker {
+
+enum class Policy {
+    Log,    // print the phase and size of each steady-state allocation
+    Abort   // print it, then abort so a debugger or core dump shows the caller
+};
+
+struct PhaseStats {
+    const char* name;
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+};
+
+const std::size_t MAX_PHASES = 16;
+
+// Makes name (a string literal) the calling thread's current phase and
+// returns the previous one; nullptr leaves all phases.
+const char* setPhase(const char* name);
+
+class PhaseScope {
+private:
+    const char* previous;
+
+public:
+    explicit PhaseScope(const char* name) : previous(setPhase(name)) {}
+    ~PhaseScope() { setPhase(previous); }
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+};
+
+void beginSteadyState(Policy policy);
+void endSteadyState();
+
+// Allocations made inside a phase since beginSteadyState().
+std::uint64_t steadyStateAllocations();
+
+// Allocations made by the calling thread so far, in or outside phases.
+std::uint64_t threadAllocations();
+
+// Whether allocations are counted at all in this build.
+#ifdef FRUIT_ALLOC_TRACK
+const bool TRACKING = true;
+#else
+const bool TRACKING = false;
+#endif
+
+// Fills out with up to MAX_PHASES entries and returns how many; allocations
+// outside any phase are reported under "(none)".
+std::size_t phaseStats(PhaseStats* out);
+
+void report(std::FILE* out);
+
+}  // namespace alloc_tracker
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+
+#ifdef FRUIT_ALLOC_TRACK
+#define ALLOC_PHASE(name) ::alloc_tracker::PhaseScope ALLOC_CONCAT(allocPhase, __LINE__)(name)
+#else
+#define ALLOC_PHASE(name) do {} while (0)
+#endif
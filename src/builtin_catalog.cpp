@@ -0,0 +1,17 @@
+#include "builtin_catalog.h"
+
+#include "catalog_data.h"
+
+Catalog builtinCatalog() {
+    Catalog catalog;
+    catalog.fruits.reserve(CATALOG_FRUITS.size());
+    for (const auto& entry : CATALOG_FRUITS) {
+        catalog.fruits.push_back(Fruit{entry.type, entry.symbol});
+    }
+    catalog.baskets.reserve(CATALOG_BASKETS.size());
+    for (const auto& entry : CATALOG_BASKETS) {
+        catalog.baskets.push_back(Basket{entry.x, entry.type, entry.symbol});
+    }
+    catalog.tuning = CATALOG_TUNING;
+    return catalog;
+}
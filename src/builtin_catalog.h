@@ -0,0 +1,20 @@
+#pragma once
+
+#include "catalog.h"
+
+// Entries of the catalog compiled into the binary. The tables themselves are
+// generated from data/catalog.json by tools/catalog_gen into
+// src/catalog_data.h at build time.
+struct CatalogFruitEntry {
+    const char* type;
+    char symbol;
+};
+
+struct CatalogBasketEntry {
+    int x;
+    const char* type;
+    char symbol;
+};
+
+// The compiled-in catalog; no file access or parsing.
+Catalog builtinCatalog();
@@ -0,0 +1,290 @@
+#include "catalog.h"
+
+#include <cstdio>
+#include <exception>
+#include <memory>
+
+#include "json_instances.h"
+
+using json = nlohmann::json;
+
+// Symbols are one-character strings in the file, so Fruit and Basket are
+// converted by hand; the rest uses the generated conversions.
+void to_json(json& j, const Fruit& fruit) {
+    j = json{{"type", fruit.type}, {"symbol", std::string(1, fruit.symbol)}};
+}
+
+// An empty symbol becomes '\0', which validateCatalog rejects
+static char symbolOf(const json& j) {
+    const std::string& symbol = j.at("symbol").get_ref<const std::string&>();
+    return symbol.empty() ? '\0' : symbol[0];
+}
+
+void from_json(const json& j, Fruit& fruit) {
+    j.at("type").get_to(fruit.type);
+    fruit.symbol = symbolOf(j);
+}
+
+void to_json(json& j, const Basket& basket) {
+    j = json{{"x", basket.x}, {"type", basket.type}, {"symbol", std::string(1, basket.symbol)}};
+}
+
+void from_json(const json& j, Basket& basket) {
+    j.at("x").get_to(basket.x);
+    j.at("type").get_to(basket.type);
+    basket.symbol = symbolOf(j);
+}
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(Tuning, tickMs, catchPoints, missPenalty)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(Catalog, fruits, baskets, tuning)
+
+namespace {
+
+// SAX binder for the catalog layout. Depth 1 is the root object, depth 2 a
+// section (the fruits/baskets arrays or the tuning object) and depth 3 a
+// fruit or basket; anything deeper is skipped.
+class CatalogSaxHandler : public nlohmann::json_sax<json> {
+private:
+    enum class Section { None, Fruits, Baskets, Tuning };
+    enum class Field { None, Type, Symbol, X, TickMs, CatchPoints, MissPenalty };
+
+    Catalog& out;
+    std::string& error;
+    int depth;
+    Section section;
+    Field field;
+
+    bool setNumber(std::int64_t value) {
+        int v = static_cast<int>(value);
+        if (depth == 3 && section == Section::Baskets && field == Field::X) {
+            out.baskets.back().x = v;
+        } else if (depth == 2 && section == Section::Tuning) {
+            if (field == Field::TickMs) out.tuning.tickMs = v;
+            else if (field == Field::CatchPoints) out.tuning.catchPoints = v;
+            else if (field == Field::MissPenalty) out.tuning.missPenalty = v;
+        }
+        field = Field::None;
+        return true;
+    }
+
+public:
+    CatalogSaxHandler(Catalog& out, std::string& error)
+        : out(out), error(error), depth(0), section(Section::None), field(Field::None) {}
+
+    bool null() override { field = Field::None; return true; }
+    bool boolean(bool) override { field = Field::None; return true; }
+    bool number_integer(number_integer_t val) override { return setNumber(val); }
+    bool number_unsigned(number_unsigned_t val) override {
+        return setNumber(static_cast<std::int64_t>(val));
+    }
+    bool number_float(number_float_t val, const string_t&) override {
+        return setNumber(static_cast<std::int64_t>(val));
+    }
+
+    bool string(string_t& val) override {
+        if (depth == 3 && (field == Field::Type || field == Field::Symbol)) {
+            if (section == Section::Fruits) {
+                Fruit& fruit = out.fruits.back();
+                if (field == Field::Type) fruit.type = std::move(val);
+                else fruit.symbol = val.empty() ? '\0' : val[0];
+            } else if (section == Section::Baskets) {
+                Basket& basket = out.baskets.back();
+                if (field == Field::Type) basket.type = std::move(val);
+                else basket.symbol = val.empty() ? '\0' : val[0];
+            }
+        }
+        field = Field::None;
+        return true;
+    }
+
+    bool binary(binary_t&) override { field = Field::None; return true; }
+
+    bool start_object(std::size_t) override {
+        depth++;
+        if (depth == 3) {
+            if (section == Section::Fruits) out.fruits.push_back(Fruit{"", '?'});
+            else if (section == Section::Baskets) out.baskets.push_back(Basket{0, "", '?'});
+        }
+        field = Field::None;
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (depth == 1) {
+            if (val == "fruits") section = Section::Fruits;
+            else if (val == "baskets") section = Section::Baskets;
+            else if (val == "tuning") section = Section::Tuning;
+            else section = Section::None;
+        } else if (depth == 2 && section == Section::Tuning) {
+            if (val == "tickMs") field = Field::TickMs;
+            else if (val == "catchPoints") field = Field::CatchPoints;
+            else if (val == "missPenalty") field = Field::MissPenalty;
+            else field = Field::None;
+        } else if (depth == 3) {
+            if (val == "type") field = Field::Type;
+            else if (val == "symbol") field = Field::Symbol;
+            else if (val == "x") field = Field::X;
+            else field = Field::None;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        depth--;
+        if (depth == 1) section = Section::None;
+        field = Field::None;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        depth++;
+        field = Field::None;
+        return true;
+    }
+
+    bool end_array() override {
+        depth--;
+        if (depth == 1) section = Section::None;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&,
+                     const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        return false;
+    }
+};
+
+}  // namespace
+
+bool loadCatalog(const std::string& path, Catalog& out, std::string& error) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out = Catalog{};
+    CatalogSaxHandler handler(out, error);
+    if (!json::sax_parse(file.get(), &handler)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool parseCatalog(const std::string& text, Catalog& out, std::string& error) {
+    out = Catalog{};
+    CatalogSaxHandler handler(out, error);
+    return json::sax_parse(text, &handler);
+}
+
+bool parseCatalogDom(const std::string& text, Catalog& out, std::string& error) {
+    try {
+        json::parse(text).get_to(out);
+    } catch (const std::exception& ex) {
+        error = ex.what();
+        return false;
+    }
+    return true;
+}
+
+bool validateCatalog(const Catalog& catalog, int width, std::string& error) {
+    auto printable = [](char symbol) { return symbol > ' ' && symbol < 0x7f; };
+    const std::vector<Fruit>& fruits = catalog.fruits;
+    if (fruits.empty() || fruits.size() > static_cast<std::size_t>(MAX_FRUITS)) {
+        error = "catalog needs 1 to " + std::to_string(MAX_FRUITS) + " fruits, has " +
+                std::to_string(fruits.size());
+        return false;
+    }
+    for (std::size_t i = 0; i < fruits.size(); i++) {
+        if (fruits[i].type.empty() || !printable(fruits[i].symbol)) {
+            error = "fruit " + std::to_string(i) + " needs a type and a printable symbol";
+            return false;
+        }
+        for (std::size_t j = 0; j < i; j++) {
+            if (fruits[j].type == fruits[i].type) {
+                error = "fruit type " + fruits[i].type + " appears twice";
+                return false;
+            }
+        }
+    }
+
+    const std::vector<Basket>& baskets = catalog.baskets;
+    if (baskets.empty()) {
+        // A basket and the gap before the next
+        if (width / static_cast<int>(fruits.size()) < 2) {
+            error = "no room for " + std::to_string(fruits.size()) + " baskets in " +
+                    std::to_string(width) + " columns";
+            return false;
+        }
+    } else {
+        if (baskets.size() > static_cast<std::size_t>(MAX_FRUITS)) {
+            error = "catalog has more than " + std::to_string(MAX_FRUITS) + " baskets";
+            return false;
+        }
+        for (const Basket& basket : baskets) {
+            if (basket.x < 0 || basket.x >= width || !printable(basket.symbol)) {
+                error = "basket " + basket.type + " needs a printable symbol and x within 0 to " +
+                        std::to_string(width - 1);
+                return false;
+            }
+        }
+        for (const Fruit& fruit : fruits) {
+            bool found = false;
+            for (const Basket& basket : baskets) found = found || basket.type == fruit.type;
+            if (!found) {
+                error = "no basket for fruit type " + fruit.type;
+                return false;
+            }
+        }
+    }
+
+    const Tuning& tuning = catalog.tuning;
+    if (tuning.tickMs <= 0 || tuning.catchPoints < 0 || tuning.missPenalty < 0) {
+        error = "tuning needs tickMs above 0 and catchPoints and missPenalty of 0 or more";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+struct Fnv1a {
+    std::uint32_t value = 2166136261u;
+
+    void add(const void* data, std::size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; i++) value = (value ^ bytes[i]) * 16777619u;
+    }
+    void add(const std::string& text) {
+        // The terminator keeps "ab","c" apart from "a","bc"
+        add(text.c_str(), text.size() + 1);
+    }
+    void add(int number) { add(&number, sizeof(number)); }
+    void add(char symbol) { add(&symbol, 1); }
+};
+
+}  // namespace
+
+std::uint32_t catalogHash(const Catalog& catalog) {
+    Fnv1a hash;
+    hash.add(static_cast<int>(catalog.fruits.size()));
+    for (const Fruit& fruit : catalog.fruits) {
+        hash.add(fruit.type);
+        hash.add(fruit.symbol);
+    }
+    hash.add(static_cast<int>(catalog.baskets.size()));
+    for (const Basket& basket : catalog.baskets) {
+        hash.add(basket.x);
+        hash.add(basket.type);
+        hash.add(basket.symbol);
+    }
+    hash.add(catalog.tuning.tickMs);
+    hash.add(catalog.tuning.catchPoints);
+    hash.add(catalog.tuning.missPenalty);
+    return hash.value;
+}
+
+std::string catalogToJson(const Catalog& catalog) {
+    return json(catalog).dump(2);
+}
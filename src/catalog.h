@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game_types.h"
+
+// Gameplay tuning that can be changed without rebuilding.
+struct Tuning {
+    int tickMs = 200;
+    int catchPoints = 10;
+    int missPenalty = 5;
+};
+
+// Baskets are picked with the number keys 1 to 9.
+const int MAX_FRUITS = 9;
+
+// Fruit types, optional fixed basket layout and tuning, as loaded from a
+// catalog file:
+//
+//   {
+//     "fruits": [ {"type": "apple", "symbol": "A"}, ... ],
+//     "baskets": [ {"x": 10, "type": "apple", "symbol": "A"}, ... ],
+//     "tuning": {"tickMs": 200, "catchPoints": 10, "missPenalty": 5}
+//   }
+//
+// "baskets" and "tuning" may be left out.
+struct Catalog {
+    std::vector<Fruit> fruits;
+    std::vector<Basket> baskets;
+    Tuning tuning;
+};
+
+// Decodes the catalog in one pass with a SAX binder that writes straight
+// into the structs; no json DOM is built.
+bool loadCatalog(const std::string& path, Catalog& out, std::string& error);
+bool parseCatalog(const std::string& text, Catalog& out, std::string& error);
+
+// Same result through a json DOM and the generated from_json functions.
+bool parseCatalogDom(const std::string& text, Catalog& out, std::string& error);
+
+// Checks that a loaded catalog can be played on a playfield width columns
+// wide: 1 to MAX_FRUITS fruits with distinct types and printable symbols,
+// a basket for every fruit type within the width when the layout is fixed,
+// room for a basket per fruit otherwise, a positive tick and no negative
+// points. Returns false with the first problem in error.
+bool validateCatalog(const Catalog& catalog, int width, std::string& error);
+
+// FNV-1a over everything that affects play: fruits, baskets and tuning.
+// Kept in the session log so a session is only resumed under the catalog
+// it was started with.
+std::uint32_t catalogHash(const Catalog& catalog);
+
+std::string catalogToJson(const Catalog& catalog);
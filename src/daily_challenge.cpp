@@ -0,0 +1,231 @@
+#include "daily_challenge.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+#include "json_instances.h"
+
+namespace {
+
+using json = nlohmann::json;
+
+const int CACHE_VERSION = 2;
+const int MAX_REROLLS = 16;
+
+std::uint64_t mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform value in [low, high] from a seed stream.
+int roll(std::uint64_t& state, int low, int high) {
+    state += 0x9e3779b97f4a7c15ULL;
+    return low + static_cast<int>(mix(state) % static_cast<std::uint64_t>(high - low + 1));
+}
+
+// A decent player: needs reactionMs to spot a fruit and sorts it correctly
+// nine times out of ten. Returns the score and the number of catches.
+int playBot(const DailyChallenge& challenge, const Catalog& catalog, int width, int height, int& caught) {
+    const int reactionMs = 800;
+    Simulation sim(catalog.fruits, challengeConfig(challenge, catalog, width, height), challenge.seed);
+    int baskets = static_cast<int>(sim.getBaskets().size());
+    std::uint64_t botState = challenge.seed ^ 0x5bd1e995ULL;
+    caught = 0;
+
+    while (sim.spawnedCount() < challenge.fruitCount || sim.fruit()) {
+        if (!sim.fruit()) sim.spawnFruit();
+        int waitedMs = 0;
+        SimEvent event = SimEvent::None;
+        while (event == SimEvent::None && sim.fruit()) {
+            if (waitedMs >= reactionMs) {
+                int basket = sim.fruitIndex();
+                if (roll(botState, 0, 9) == 0) basket = (basket + 1) % baskets;
+                event = sim.sortInto(basket);
+            } else {
+                waitedMs += sim.tickMs();
+                event = sim.tick();
+            }
+        }
+        if (event == SimEvent::Caught) caught++;
+    }
+    return sim.getScore();
+}
+
+json toJson(const DailyChallenge& c) {
+    return {
+        {"date", dayString(c.day)},
+        {"day", c.day},
+        {"catalog", c.catalog},
+        {"seed", c.seed},
+        {"weights", c.fruitWeights},
+        {"start_ms", c.startTickMs},
+        {"end_ms", c.endTickMs},
+        {"step_ms", c.tickMsStep},
+        {"fruits", c.fruitCount},
+        {"target", c.targetScore},
+    };
+}
+
+DailyChallenge fromJson(const json& j) {
+    DailyChallenge c;
+    c.day = j.at("day").get<int>();
+    c.catalog = j.at("catalog").get<std::uint32_t>();
+    c.seed = j.at("seed").get<std::uint64_t>();
+    c.fruitWeights = j.at("weights").get<std::vector<int>>();
+    c.startTickMs = j.at("start_ms").get<int>();
+    c.endTickMs = j.at("end_ms").get<int>();
+    c.tickMsStep = j.at("step_ms").get<int>();
+    c.fruitCount = j.at("fruits").get<int>();
+    c.targetScore = j.at("target").get<int>();
+    return c;
+}
+
+}  // namespace
+
+int dayNumber(std::int64_t time) {
+    return static_cast<int>((time >= 0 ? time : time - 86399) / 86400);
+}
+
+std::string dayString(int day) {
+    std::time_t t = static_cast<std::time_t>(day) * 86400;
+    std::tm tm{};
+    gmtime_r(&t, &tm);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm);
+    return buffer;
+}
+
+SimulationConfig challengeConfig(const DailyChallenge& challenge, const Catalog& catalog,
+                                 int width, int height) {
+    return SimulationConfig{width, height, challenge.startTickMs, challenge.endTickMs,
+                            challenge.tickMsStep, challenge.fruitWeights, catalog.baskets,
+                            catalog.tuning.catchPoints, catalog.tuning.missPenalty};
+}
+
+DailyChallenge generateDailyChallenge(int day, const Catalog& catalog, int width, int height) {
+    const std::vector<Fruit>& fruits = catalog.fruits;
+    std::uint64_t state = mix(static_cast<std::uint64_t>(day) ^ 0xda11c4a11e6eULL);
+    DailyChallenge challenge;
+    challenge.catalog = catalogHash(catalog);
+
+    for (int attempt = 0; attempt < MAX_REROLLS; attempt++) {
+        challenge.day = day;
+        challenge.seed = mix(state + attempt);
+        challenge.fruitWeights.assign(fruits.size(), 0);
+        for (int& weight : challenge.fruitWeights) weight = roll(state, 1, 8);
+        challenge.startTickMs = roll(state, 150, 250);
+        challenge.endTickMs = roll(state, 40, challenge.startTickMs);
+        challenge.tickMsStep = roll(state, 1, 5);
+        challenge.fruitCount = roll(state, 30, 60);
+
+        int caught = 0;
+        int botScore = playBot(challenge, catalog, width, height, caught);
+        // Reject days where even the bot drops too much: the speed curve is
+        // too steep for the playfield height.
+        if (caught * 10 < challenge.fruitCount * 6) continue;
+
+        challenge.targetScore = (botScore * 4 / 5) / 5 * 5;
+        return challenge;
+    }
+
+    // Nothing passed validation; fall back to the gentlest curve
+    challenge.startTickMs = 200;
+    challenge.endTickMs = 200;
+    challenge.tickMsStep = 0;
+    int caught = 0;
+    challenge.targetScore = (playBot(challenge, catalog, width, height, caught) * 4 / 5) / 5 * 5;
+    return challenge;
+}
+
+ChallengeCache::ChallengeCache(const std::string& path) : path(path), unsaved(false) {}
+
+ChallengeCache::~ChallengeCache() {
+    wait();
+}
+
+bool ChallengeCache::load(std::string& error) {
+    std::ifstream in(path);
+    if (!in) return true;
+    try {
+        json doc = json::parse(in);
+        if (doc.value("version", 0) != CACHE_VERSION) return true;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& item : doc.at("days")) {
+            DailyChallenge challenge = fromJson(item);
+            days[challenge.day] = challenge;
+        }
+    } catch (const json::exception& ex) {
+        error = path + ": " + ex.what();
+        return false;
+    }
+    return true;
+}
+
+bool ChallengeCache::save(std::string& error) const {
+    json doc = {{"version", CACHE_VERSION}, {"days", json::array()}};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : days) doc["days"].push_back(toJson(entry.second));
+    }
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        out << doc.dump(2) << "\n";
+        if (!out) {
+            error = "cannot write " + tmpPath;
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        error = "cannot replace " + path;
+        return false;
+    }
+    return true;
+}
+
+bool ChallengeCache::find(int day, DailyChallenge& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = days.find(day);
+    if (it == days.end()) return false;
+    out = it->second;
+    return true;
+}
+
+DailyChallenge ChallengeCache::get(int day, const Catalog& catalog, int width, int height) {
+    DailyChallenge challenge;
+    // A challenge made for a different catalog, even one that only changed
+    // its tuning or baskets, had its target set under other rules
+    if (find(day, challenge) && challenge.catalog == catalogHash(catalog)) return challenge;
+    challenge = generateDailyChallenge(day, catalog, width, height);
+    std::lock_guard<std::mutex> lock(mutex);
+    days[day] = challenge;
+    unsaved = true;
+    return challenge;
+}
+
+void ChallengeCache::prefetch(int firstDay, int count, const Catalog& catalog, int width, int height) {
+    wait();
+    worker = std::thread([this, firstDay, count, catalog, width, height] {
+        for (int day = firstDay; day < firstDay + count; day++) get(day, catalog, width, height);
+        bool changed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            changed = unsaved;
+            unsaved = false;
+            while (!days.empty() && days.begin()->first < firstDay) {
+                days.erase(days.begin());
+                changed = true;
+            }
+        }
+        std::string error;
+        if (changed && !save(error)) std::cerr << "daily challenges: " << error << "\n";
+    });
+}
+
+void ChallengeCache::wait() {
+    if (worker.joinable()) worker.join();
+}
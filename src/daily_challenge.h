@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catalog.h"
+#include "game_types.h"
+#include "simulation.h"
+
+// One day's challenge. Everything is derived from the day number, so every
+// player gets the same fruit sequence and pacing on the same date.
+struct DailyChallenge {
+    int day;                    // days since 1970-01-01, UTC
+    std::uint32_t catalog;      // catalogHash of the catalog it was made for
+    std::uint64_t seed;         // simulation seed for the day
+    std::vector<int> fruitWeights;
+    int startTickMs;
+    int endTickMs;
+    int tickMsStep;
+    int fruitCount;             // fruits to sort
+    int targetScore;
+};
+
+// Day number of a time_t in UTC.
+int dayNumber(std::int64_t time);
+
+// Formats a day number as YYYY-MM-DD.
+std::string dayString(int day);
+
+// Derives the challenge for a day and validates it by letting a bot play it
+// on the shared simulation core, with the catalog's baskets and scoring.
+// Candidates the bot cannot reasonably clear are rerolled, and the target
+// is set from the bot's score.
+DailyChallenge generateDailyChallenge(int day, const Catalog& catalog, int width, int height);
+
+// Simulation settings for playing a challenge under the catalog's baskets
+// and tuning.
+SimulationConfig challengeConfig(const DailyChallenge& challenge, const Catalog& catalog,
+                                 int width, int height);
+
+// On-disk cache of generated challenges. Startup reads the cache file and
+// generates only today's challenge if it is missing; prefetch() generates
+// the rest of the upcoming window on a background thread and rewrites the
+// file when done.
+class ChallengeCache {
+private:
+    std::string path;
+    mutable std::mutex mutex;
+    std::map<int, DailyChallenge> days;
+    bool unsaved;               // days generated since the file was written
+    std::thread worker;
+
+    bool save(std::string& error) const;
+
+public:
+    explicit ChallengeCache(const std::string& path);
+    ~ChallengeCache();
+    ChallengeCache(const ChallengeCache&) = delete;
+    ChallengeCache& operator=(const ChallengeCache&) = delete;
+
+    // A missing file is not an error; the cache just starts empty.
+    bool load(std::string& error);
+
+    // False if the day has not been generated yet.
+    bool find(int day, DailyChallenge& out) const;
+
+    // The day's challenge for this catalog, generated now if the cache has
+    // none or only one made for another catalog; the next prefetch writes
+    // it out.
+    DailyChallenge get(int day, const Catalog& catalog, int width, int height);
+
+    // Generates days [firstDay, firstDay + count) that are not cached for
+    // this catalog yet and drops days before firstDay. Runs in the
+    // background.
+    void prefetch(int firstDay, int count, const Catalog& catalog, int width, int height);
+
+    // Waits for a running prefetch.
+    void wait();
+};
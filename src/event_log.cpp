@@ -0,0 +1,199 @@
+#include "event_log.h"
+#include "profiler.h"
+#include "util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char WAL_MAGIC[8] = {'F', 'R', 'U', 'I', 'T', 'W', 'A', 'L'};
+
+struct CrcTable {
+    std::uint32_t entries[256];
+
+    CrcTable() {
+        for (std::uint32_t i = 0; i < 256; i++) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+const CrcTable crcTable;
+
+std::uint32_t recordCrc(const WalRecord& record) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&record);
+    std::uint32_t c = 0xffffffffu;
+    for (std::size_t i = sizeof(record.crc); i < sizeof(WalRecord); i++) {
+        c = crcTable.entries[(c ^ bytes[i]) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffffu;
+}
+
+// Makes a rename into path's directory durable
+bool syncDirectory(const std::string& path) {
+    std::size_t slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir < 0) return false;
+    bool ok = fsync(dir) == 0;
+    ::close(dir);
+    return ok;
+}
+
+}  // namespace
+
+EventLog::EventLog(std::size_t capacity, int flushIntervalMs, std::size_t batchEvents)
+    : ring(roundUpPow2(capacity)), mask(ring.size() - 1), batchEvents(batchEvents),
+      flushIntervalMs(flushIntervalMs), fd(-1), head(0), tailCache(0), notifiedAt(0), tail(0),
+      committedCount(0), stopping(false) {
+    batch.reserve(ring.size());
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+bool EventLog::open(const std::string& path, std::string& error) {
+    close();
+    std::string tmpPath = path + ".tmp";
+    fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "cannot open " + tmpPath;
+        return false;
+    }
+    if (!writeAll(fd, WAL_MAGIC, sizeof(WAL_MAGIC))) {
+        error = "cannot write " + tmpPath;
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    this->path = path;
+    return true;
+}
+
+bool EventLog::start(std::string& error) {
+    if (fd < 0) {
+        error = "session log is not open";
+        return false;
+    }
+    std::string tmpPath = path + ".tmp";
+    // commit syncs the records it writes; the magic alone needs its own
+    bool synced = head.load(std::memory_order_relaxed) != tail.load(std::memory_order_relaxed)
+                      ? commit()
+                      : fdatasync(fd) == 0;
+    if (!synced || std::rename(tmpPath.c_str(), path.c_str()) != 0 || !syncDirectory(path)) {
+        error = "cannot replace " + path;
+        ::close(fd);
+        fd = -1;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    stopping = false;
+    writer = std::thread(&EventLog::writerLoop, this);
+    return true;
+}
+
+void EventLog::close() {
+    if (writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void EventLog::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(flushIntervalMs));
+        lock.unlock();
+        if (!commit()) std::cerr << "event log: write failed\n";
+        lock.lock();
+    }
+    lock.unlock();
+    if (!commit()) std::cerr << "event log: write failed\n";
+}
+
+bool EventLog::commit() {
+    PROFILE_ZONE("wal_commit");
+    std::uint64_t from = tail.load(std::memory_order_relaxed);
+    std::uint64_t to = head.load(std::memory_order_acquire);
+    if (from == to) return true;
+
+    batch.clear();
+    for (std::uint64_t pos = from; pos != to; pos++) {
+        batch.push_back(ring[pos & mask]);
+        batch.back().crc = recordCrc(batch.back());
+    }
+    // The slots are copied out, so the producer may reuse them right away
+    tail.store(to, std::memory_order_release);
+
+    if (!writeAll(fd, batch.data(), batch.size() * sizeof(WalRecord)) || fdatasync(fd) != 0) {
+        return false;
+    }
+    committedCount.fetch_add(batch.size(), std::memory_order_release);
+    return true;
+}
+
+bool EventLog::recover(const std::string& path, RecoveredSession& out, std::string& error) {
+    out = RecoveredSession{false, 0, -1, 0, 0, 0, 0, 0, 0};
+    int in = ::open(path.c_str(), O_RDONLY);
+    if (in < 0) return true;
+
+    char magic[sizeof(WAL_MAGIC)];
+    if (::read(in, magic, sizeof(magic)) != sizeof(magic) ||
+        std::memcmp(magic, WAL_MAGIC, sizeof(magic)) != 0) {
+        ::close(in);
+        error = path + " is not an event log";
+        return false;
+    }
+
+    // Replay up to the first short or corrupt record; anything after it was
+    // never acknowledged as committed.
+    WalRecord record;
+    while (::read(in, &record, sizeof(record)) == sizeof(record) && record.crc == recordCrc(record)) {
+        switch (record.type) {
+            case WalRecordType::SessionStart:
+                out = RecoveredSession{true, static_cast<std::uint64_t>(record.value), record.aux,
+                                       static_cast<std::uint32_t>(record.score), 0, 0, 0, 0, out.records};
+                break;
+            case WalRecordType::Restore:
+                out.score = record.score;
+                out.spawned = record.aux;
+                out.caught = static_cast<int>(record.value >> 32);
+                out.missed = static_cast<int>(record.value & 0xffffffff);
+                break;
+            case WalRecordType::Spawn:
+                out.spawned = record.aux;
+                break;
+            case WalRecordType::Caught:
+                out.score = record.score;
+                out.caught++;
+                break;
+            case WalRecordType::WrongBasket:
+            case WalRecordType::Dropped:
+                out.score = record.score;
+                out.missed++;
+                break;
+            case WalRecordType::SessionEnd:
+                out.active = false;
+                break;
+        }
+        out.records++;
+    }
+    ::close(in);
+    return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class WalRecordType : std::uint8_t {
+    SessionStart = 1,   // value = simulation seed, aux = challenge day or -1,
+                        // score = catalogHash of the catalog played
+    Restore,            // resumed session: score, aux = fruits spawned,
+                        // value = caught << 32 | missed
+    Spawn,              // fruit, aux = fruits spawned so far
+    Caught,             // fruit, score after the event
+    WrongBasket,
+    Dropped,
+    SessionEnd
+};
+
+// Fixed-size log record. crc covers every byte after itself, so a torn
+// write at the tail of the log is detected on recovery.
+struct WalRecord {
+    std::uint32_t crc;
+    WalRecordType type;
+    std::int8_t fruit;
+    std::uint16_t reserved;
+    std::int32_t score;
+    std::int32_t aux;
+    std::int64_t value;
+};
+
+static_assert(sizeof(WalRecord) == 24, "WalRecord is written to disk as-is");
+
+// Session state rebuilt from the log: everything up to the last intact record.
+struct RecoveredSession {
+    bool active;            // a session was started and never ended
+    std::uint64_t seed;
+    int day;
+    std::uint32_t catalog;  // catalogHash the session was started with
+    int score;
+    int spawned;
+    int caught;
+    int missed;
+    std::uint64_t records;
+};
+
+// Append-only write-ahead log of gameplay events. append() only copies the
+// record into a single-producer ring, so it is safe to call from the tick
+// loop. A background thread drains the ring and commits it with one write and
+// one fdatasync every flushIntervalMs, or sooner once batchEvents records are
+// waiting (group commit).
+class EventLog {
+private:
+    std::vector<WalRecord> ring;
+    std::uint64_t mask;
+    std::size_t batchEvents;
+    int flushIntervalMs;
+    int fd;
+    std::string path;           // replaced by the new log once it is started
+
+    // Producer side
+    alignas(64) std::atomic<std::uint64_t> head;
+    std::uint64_t tailCache;
+    std::uint64_t notifiedAt;
+
+    // Consumer side
+    alignas(64) std::atomic<std::uint64_t> tail;
+    std::atomic<std::uint64_t> committedCount;
+    std::vector<WalRecord> batch;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread writer;
+
+    void writerLoop();
+    bool commit();
+
+public:
+    // capacity is rounded up to a power of two.
+    explicit EventLog(std::size_t capacity = 4096, int flushIntervalMs = 50,
+                      std::size_t batchEvents = 256);
+    ~EventLog();
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // Starts a fresh log beside path, in path + ".tmp". Records appended
+    // before start() go into it; the previous log at path stays in place.
+    bool open(const std::string& path, std::string& error);
+
+    // Commits the records appended since open, renames the new log over
+    // path and starts the background writer. A crash at any point leaves
+    // either the previous log or one already holding those records.
+    bool start(std::string& error);
+
+    // Commits everything appended so far and stops the writer.
+    void close();
+
+    // Does nothing unless the log is open.
+    void append(WalRecordType type, int fruit, int score, int aux = 0, std::int64_t value = 0) {
+        if (fd < 0) return;
+        std::uint64_t pos = head.load(std::memory_order_relaxed);
+        while (pos - tailCache >= ring.size()) {
+            // Only happens if the disk stalls for a whole ring of events
+            tailCache = tail.load(std::memory_order_acquire);
+            if (pos - tailCache >= ring.size()) std::this_thread::yield();
+        }
+        WalRecord& record = ring[pos & mask];
+        record.type = type;
+        record.fruit = static_cast<std::int8_t>(fruit);
+        record.reserved = 0;
+        record.score = score;
+        record.aux = aux;
+        record.value = value;
+        head.store(pos + 1, std::memory_order_release);
+
+        // The writer also wakes on its timer, so a missed notify only delays
+        // the commit until the next interval.
+        if (pos + 1 - notifiedAt >= batchEvents) {
+            notifiedAt = pos + 1;
+            wake.notify_one();
+        }
+    }
+
+    // Records known to be on stable storage.
+    std::uint64_t committed() const { return committedCount.load(std::memory_order_acquire); }
+
+    // Replays the log at path. A missing log is not an error.
+    static bool recover(const std::string& path, RecoveredSession& out, std::string& error);
+};
@@ -0,0 +1,170 @@
+#include "frame_diff.h"
+
+#include <algorithm>
+#include <charconv>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRUIT_X86 1
+#endif
+
+namespace {
+
+// Rewriting this many unchanged cells is no more bytes than the cursor
+// move that would skip them
+const std::size_t MERGE_GAP = 6;
+
+std::size_t firstDifferenceScalar(const Cell* a, const Cell* b, std::size_t begin, std::size_t count) {
+    while (begin < count && a[begin] == b[begin]) begin++;
+    return begin;
+}
+
+#ifdef FRUIT_X86
+
+__attribute__((target("sse2")))
+std::size_t firstDifferenceSse2(const Cell* a, const Cell* b, std::size_t begin, std::size_t count) {
+    for (; begin + 4 <= count; begin += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + begin));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + begin));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(x, y)));
+        if (mask != 0xffff) return begin + __builtin_ctz(~mask) / 4;
+    }
+    return firstDifferenceScalar(a, b, begin, count);
+}
+
+__attribute__((target("avx2")))
+std::size_t firstDifferenceAvx2(const Cell* a, const Cell* b, std::size_t begin, std::size_t count) {
+    for (; begin + 8 <= count; begin += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + begin));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + begin));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, y)));
+        if (mask != 0xffffffffu) return begin + __builtin_ctz(~mask) / 4;
+    }
+    // The tail stays in this function: a tail call into SSE code would
+    // skip the vzeroupper on return and pay the AVX-SSE transition
+    while (begin < count && a[begin] == b[begin]) begin++;
+    return begin;
+}
+
+bool hasSse2() { return __builtin_cpu_supports("sse2"); }
+bool hasAvx2() { return __builtin_cpu_supports("avx2"); }
+
+#endif
+
+struct Dispatch {
+    RowComparator compare;
+    const char* isa;
+};
+
+Dispatch choose() {
+#ifdef FRUIT_X86
+    if (hasAvx2()) return {firstDifferenceAvx2, "avx2"};
+    if (hasSse2()) return {firstDifferenceSse2, "sse2"};
+#endif
+    return {firstDifferenceScalar, "scalar"};
+}
+
+const Dispatch dispatch = choose();
+
+void diffRow(const Framebuffer& previous, const Framebuffer& current, int y, std::vector<Span>& spans) {
+    if (previous.rowHash(y) == current.rowHash(y)) return;
+
+    // Cells outside both extents are blank in both frames
+    RowExtent was = previous.rowExtent(y);
+    RowExtent is = current.rowExtent(y);
+    std::size_t x = static_cast<std::size_t>(std::min(was.begin, is.begin));
+    std::size_t limit = static_cast<std::size_t>(std::max(was.end, is.end));
+    const Cell* before = previous.row(y);
+    const Cell* after = current.row(y);
+    x = dispatch.compare(before, after, x, limit);
+    while (x < limit) {
+        std::size_t begin = x;
+        std::size_t end;
+        for (;;) {
+            end = x + 1;
+            while (end < limit && before[end] != after[end]) end++;
+            x = dispatch.compare(before, after, end, limit);
+            if (x >= limit || x - end > MERGE_GAP) break;
+        }
+        spans.push_back(Span{y, static_cast<int>(begin), static_cast<int>(end)});
+    }
+}
+
+void appendCursor(std::string& out, int row, int column) {
+    char buffer[32];
+    char* p = buffer;
+    *p++ = '\x1b';
+    *p++ = '[';
+    p = std::to_chars(p, buffer + 14, row + 1).ptr;
+    *p++ = ';';
+    p = std::to_chars(p, buffer + 28, column + 1).ptr;
+    *p++ = 'H';
+    out.append(buffer, p - buffer);
+}
+
+}  // namespace
+
+std::size_t firstDifference(const Cell* a, const Cell* b, std::size_t begin, std::size_t count) {
+    return dispatch.compare(a, b, begin, count);
+}
+
+const char* firstDifferenceIsa() {
+    return dispatch.isa;
+}
+
+RowComparator scalarComparator() {
+    return firstDifferenceScalar;
+}
+
+RowComparator sse2Comparator() {
+#ifdef FRUIT_X86
+    if (hasSse2()) return firstDifferenceSse2;
+#endif
+    return nullptr;
+}
+
+RowComparator avx2Comparator() {
+#ifdef FRUIT_X86
+    if (hasAvx2()) return firstDifferenceAvx2;
+#endif
+    return nullptr;
+}
+
+bool diffFrames(const Framebuffer& previous, const Framebuffer& current, std::vector<Span>& spans) {
+    spans.clear();
+    if (previous.getWidth() != current.getWidth() || previous.getHeight() != current.getHeight()) {
+        return false;
+    }
+
+    // Rows neither frame wrote are blank in both. Rows both wrote are
+    // visited from previous's list only.
+    for (int y : previous.touchedRows()) diffRow(previous, current, y, spans);
+    for (int y : current.touchedRows()) {
+        RowExtent was = previous.rowExtent(y);
+        if (was.begin >= was.end) diffRow(previous, current, y, spans);
+    }
+    return true;
+}
+
+std::size_t emitChanges(std::string& out, const Theme& theme, const Framebuffer& current,
+                        const std::vector<Span>& spans) {
+    std::size_t start = out.size();
+    // Both emit functions leave the terminal in the default style
+    Style style = Style::Default;
+    for (const Span& span : spans) {
+        appendCursor(out, span.row, span.begin);
+        const Cell* cells = current.row(span.row);
+        for (int x = span.begin; x < span.end; x++) {
+            char32_t glyph = cellGlyph(cells[x]);
+            Style next = cellStyle(cells[x]);
+            bool blank = glyph == ' ' && !theme.paints(next);
+            if (next != style && (!blank || theme.paints(style))) {
+                out += theme.sequence(next);
+                style = next;
+            }
+            appendUtf8(out, glyph);
+        }
+    }
+    if (style != Style::Default) out += theme.sequence(Style::Default);
+    return out.size() - start;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "framebuffer.h"
+#include "theme.h"
+
+// Cells [begin, end) of one row that differ from the frame on screen.
+struct Span {
+    int row;
+    int begin;
+    int end;
+};
+
+// Returns the index of the first cell in [begin, count) where a and b
+// differ, or count if they are equal. Compares 8 cells per step with AVX2
+// or 4 with SSE2, whichever the CPU supports; firstDifferenceIsa() names
+// the one chosen.
+std::size_t firstDifference(const Cell* a, const Cell* b, std::size_t begin, std::size_t count);
+const char* firstDifferenceIsa();
+
+// The individual implementations, for benchmarks. The SIMD ones are null
+// where the build or the CPU does not support them.
+using RowComparator = std::size_t (*)(const Cell*, const Cell*, std::size_t, std::size_t);
+RowComparator scalarComparator();
+RowComparator sse2Comparator();
+RowComparator avx2Comparator();
+
+// Replaces spans with the cells of current that differ from previous.
+// Only rows either frame wrote are visited, rows whose hashes match are
+// skipped without reading their cells, and in the rest only the columns
+// either frame wrote are compared, so the cost follows what was drawn
+// rather than the frame size. Changed cells closer than a cursor move's
+// worth of bytes are merged into one span; rows come in no particular
+// order. Returns false, leaving spans empty, if the frames are not the
+// same size.
+bool diffFrames(const Framebuffer& previous, const Framebuffer& current, std::vector<Span>& spans);
+
+// Appends the cells of current covered by spans to out, each span
+// preceded by a cursor move. Styles follow the same rules as
+// Framebuffer::emit, except that blanks are always written since they
+// overwrite what was there. Returns the number of bytes appended.
+std::size_t emitChanges(std::string& out, const Theme& theme, const Framebuffer& current,
+                        const std::vector<Span>& spans);
@@ -0,0 +1,180 @@
+#include "frame_writer.h"
+
+#include <cerrno>
+#include <iostream>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "terminal.h"
+
+namespace {
+
+// How long closing waits for a stalled terminal to take more, as leaving
+// the session does
+const int CLOSE_TIMEOUT_MS = 500;
+
+}  // namespace
+
+FrameWriter::FrameWriter(std::size_t maxQueued)
+    : fd(-1), owned(false), socket(false), queue(Queue::None), maxQueued(maxQueued), pendingAt(0),
+      sentCount(0), droppedCount(0), failedCount(0), failure(0), damaged(false) {}
+
+FrameWriter::~FrameWriter() {
+    close();
+}
+
+#ifndef _WIN32
+
+bool FrameWriter::open(int descriptor) {
+    close();
+    struct stat info{};
+    if (fstat(descriptor, &info) != 0) return false;
+    socket = S_ISSOCK(info.st_mode);
+    if (socket || S_ISREG(info.st_mode)) {
+        // send() is told not to wait, and a file never makes a write wait
+        fd = descriptor;
+        owned = false;
+    } else {
+        fd = reopenNonBlocking(descriptor);
+        if (fd < 0) return false;
+        owned = true;
+    }
+    // FIONREAD on a terminal counts input, so it is only asked of pipes
+    queue = Queue::None;
+    if (isatty(fd) || socket) {
+        queue = Queue::Output;
+    } else if (S_ISFIFO(info.st_mode)) {
+        queue = Queue::Pipe;
+    }
+    // A frame rarely comes near this, so keeping one does not allocate
+    pending.reserve(64 * 1024);
+    return true;
+}
+
+void FrameWriter::close() {
+    if (fd < 0) return;
+    while (pendingAt < pending.size()) {
+        long count = writeSome(pending.data() + pendingAt, pending.size() - pendingAt);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                pollfd out{fd, POLLOUT, 0};
+                if (poll(&out, 1, CLOSE_TIMEOUT_MS) == 0) break;
+                continue;
+            }
+            fail();
+            break;
+        }
+        pendingAt += count;
+    }
+    pending.clear();
+    pendingAt = 0;
+    if (owned) ::close(fd);
+    fd = -1;
+}
+
+long FrameWriter::writeSome(const char* data, std::size_t size) {
+    if (socket) return ::send(fd, data, size, MSG_DONTWAIT);
+    return write(fd, data, size);
+}
+
+void FrameWriter::flush() {
+    while (pendingAt < pending.size()) {
+        long count = writeSome(pending.data() + pendingAt, pending.size() - pendingAt);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) return;
+            fail();
+            return;
+        }
+        pendingAt += count;
+    }
+    pending.clear();
+    pendingAt = 0;
+}
+
+void FrameWriter::fail() {
+    failedCount++;
+    failure = errno;
+    damaged = true;
+    pending.clear();
+    pendingAt = 0;
+}
+
+std::size_t FrameWriter::queuedBytes() const {
+    int bytes = 0;
+    if (queue == Queue::Output && ioctl(fd, TIOCOUTQ, &bytes) == 0) return bytes;
+    if (queue == Queue::Pipe && ioctl(fd, FIONREAD, &bytes) == 0) return bytes;
+    return 0;
+}
+
+bool FrameWriter::beginFrame() {
+    if (fd < 0) return true;
+    flush();
+    if (pendingBytes() > 0 || queuedBytes() > maxQueued) {
+        droppedCount++;
+        return false;
+    }
+    return true;
+}
+
+void FrameWriter::send(const std::string& frame) {
+    sentCount++;
+    if (fd < 0) {
+        std::cout.write(frame.data(), frame.size());
+        std::cout.flush();
+        return;
+    }
+    std::size_t written = 0;
+    while (written < frame.size()) {
+        long count = writeSome(frame.data() + written, frame.size() - written);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                pending.assign(frame, written, std::string::npos);
+            } else {
+                fail();
+            }
+            return;
+        }
+        written += count;
+    }
+}
+
+#else
+
+bool FrameWriter::open(int) {
+    return false;
+}
+
+void FrameWriter::close() {}
+
+long FrameWriter::writeSome(const char*, std::size_t) {
+    return -1;
+}
+
+void FrameWriter::flush() {}
+
+void FrameWriter::fail() {}
+
+std::size_t FrameWriter::queuedBytes() const {
+    return 0;
+}
+
+bool FrameWriter::beginFrame() {
+    return true;
+}
+
+void FrameWriter::send(const std::string& frame) {
+    sentCount++;
+    std::cout.write(frame.data(), frame.size());
+    std::cout.flush();
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Writes frames to the terminal without ever blocking the game loop. They
+// go through a non-blocking descriptor of its own (reopenNonBlocking), or
+// with send(MSG_DONTWAIT) to a socket, so the descriptor given to open,
+// and stdin and stderr sharing it, stay blocking for everything else.
+// What the terminal does not take at once is kept and sent by later
+// frames. While anything is kept, or while more than maxQueued bytes wait
+// in the output queue of the terminal (TIOCOUTQ) or pipe (FIONREAD),
+// frames are dropped rather than queued behind it. The caller then diffs
+// the next frame it sends against the last one sent, so a dropped frame's
+// changes are merged into it and only the latest state goes out once the
+// link drains.
+class FrameWriter {
+private:
+    enum class Queue { None, Output, Pipe };
+
+    int fd;                     // written to, -1 when not open
+    bool owned;                 // fd was opened by open and is closed by close
+    bool socket;
+    Queue queue;
+    std::size_t maxQueued;
+    std::string pending;        // unsent tail of the last frame
+    std::size_t pendingAt;
+    std::uint64_t sentCount;
+    std::uint64_t droppedCount;
+    std::uint64_t failedCount;
+    int failure;                // errno of the last failed write
+    bool damaged;               // part of a frame was lost since takeRedraw
+
+    // Writes what fd takes without waiting; -1 with EAGAIN when nothing.
+    long writeSome(const char* data, std::size_t size);
+
+    // Writes what it can of pending, dropping it if the descriptor fails.
+    void flush();
+
+    // Drops what is kept after a write error other than EAGAIN.
+    void fail();
+
+public:
+    explicit FrameWriter(std::size_t maxQueued = 4096);
+    ~FrameWriter();
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    // Starts writing frames to the terminal, pipe, socket or file fd
+    // writes to. Returns false if it cannot be written without blocking
+    // the descriptor. Without an open descriptor frames go to std::cout
+    // and are never dropped.
+    bool open(int fd);
+
+    // Sends what is still kept, waiting for it unless the terminal takes
+    // nothing for half a second.
+    void close();
+
+    // Called once per frame before drawing it: writes what it can of the
+    // kept bytes, then returns whether a frame may be sent now. A frame
+    // that may not is counted as dropped.
+    bool beginFrame();
+
+    // Sends frame, keeping what the terminal does not take now.
+    void send(const std::string& frame);
+
+    // Bytes waiting in the output queue, 0 when it cannot be read.
+    std::size_t queuedBytes() const;
+    std::size_t pendingBytes() const { return pending.size() - pendingAt; }
+
+    // Whether a write failed since the last call, leaving the terminal with
+    // part of a frame; the next frame must then redraw the whole screen.
+    bool takeRedraw() {
+        bool result = damaged;
+        damaged = false;
+        return result;
+    }
+
+    std::uint64_t sent() const { return sentCount; }
+    std::uint64_t dropped() const { return droppedCount; }
+    std::uint64_t failed() const { return failedCount; }
+    int lastError() const { return failure; }
+};
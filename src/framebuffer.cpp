@@ -0,0 +1,102 @@
+#include "framebuffer.h"
+
+#include <algorithm>
+
+void appendMultibyteUtf8(std::string& out, char32_t glyph) {
+    if (glyph < 0x800) {
+        out += static_cast<char>(0xc0 | (glyph >> 6));
+        out += static_cast<char>(0x80 | (glyph & 0x3f));
+    } else if (glyph < 0x10000) {
+        out += static_cast<char>(0xe0 | (glyph >> 12));
+        out += static_cast<char>(0x80 | ((glyph >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (glyph & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (glyph >> 18));
+        out += static_cast<char>(0x80 | ((glyph >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((glyph >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (glyph & 0x3f));
+    }
+}
+
+Framebuffer::Framebuffer(int width, int height) : width(0), height(0), blankRowHash(0) {
+    resize(width, height);
+}
+
+void Framebuffer::clear() {
+    Cell blank = packCell(' ', Style::Default);
+    for (int y : touched) {
+        RowExtent& extent = extents[y];
+        Cell* first = &cells[static_cast<std::size_t>(y) * width];
+        std::fill(first + extent.begin, first + extent.end, blank);
+        rowHashes[y] = blankRowHash;
+        extent = RowExtent{width, 0};
+    }
+    touched.clear();
+}
+
+void Framebuffer::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    // vector::resize keeps its capacity when shrinking
+    cells.resize(static_cast<std::size_t>(width) * height);
+    rowHashes.resize(height);
+    extents.resize(height);
+    touched.clear();
+    touched.reserve(height);
+
+    Cell blank = packCell(' ', Style::Default);
+    blankRowHash = 0;
+    for (int x = 0; x < width; x++) blankRowHash ^= cellHash(x, blank);
+    std::fill(cells.begin(), cells.end(), blank);
+    std::fill(rowHashes.begin(), rowHashes.end(), blankRowHash);
+    std::fill(extents.begin(), extents.end(), RowExtent{width, 0});
+}
+
+int Framebuffer::text(int x, int y, std::string_view text, Style style) {
+    for (char c : text) {
+        if (x >= width) break;
+        put(x++, y, static_cast<unsigned char>(c), style);
+    }
+    return x;
+}
+
+std::size_t Framebuffer::emit(std::string& out, const Theme& theme, bool overwrite) const {
+    std::size_t start = out.size();
+    // The terminal's style is unknown until the first sequence
+    bool styled = false;
+    Style current = Style::Default;
+    for (int y = 0; y < height; y++) {
+        const Cell* cellsOfRow = row(y);
+        int end = std::max(extents[y].end, 0);
+        while (end > 0 && cellGlyph(cellsOfRow[end - 1]) == ' ' &&
+               !theme.paints(cellStyle(cellsOfRow[end - 1]))) {
+            end--;
+        }
+
+        for (int x = 0; x < end; x++) {
+            char32_t glyph = cellGlyph(cellsOfRow[x]);
+            Style style = cellStyle(cellsOfRow[x]);
+            bool blank = glyph == ' ' && !theme.paints(style);
+            // A blank may stay in the current run unless that run paints
+            bool change = !styled || style != current;
+            if (change && (!blank || (styled && theme.paints(current)))) {
+                out += theme.sequence(style);
+                current = style;
+                styled = true;
+            }
+            appendUtf8(out, glyph);
+        }
+        if (overwrite) {
+            // Erasing fills with the current background
+            if (styled && theme.paints(current)) {
+                out += theme.sequence(Style::Default);
+                current = Style::Default;
+            }
+            out += "\x1b[K";
+        }
+        out += '\n';
+    }
+    if (styled && current != Style::Default) out += theme.sequence(Style::Default);
+    if (overwrite) out += "\x1b[J";
+    return out.size() - start;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "theme.h"
+
+// A cell packs its glyph (a Unicode code point, 24 bits) and its Style
+// (8 bits) into 32 bits, so rows compare as plain arrays of integers.
+using Cell = std::uint32_t;
+
+inline Cell packCell(char32_t glyph, Style style) {
+    return (static_cast<Cell>(glyph) & 0xffffff) | (static_cast<Cell>(style) << 24);
+}
+
+inline char32_t cellGlyph(Cell cell) { return cell & 0xffffff; }
+inline Style cellStyle(Cell cell) { return static_cast<Style>(cell >> 24); }
+
+// UTF-8 of the braille block (U+2800-U+28FF), which sub-cell frames are
+// mostly made of, indexed by the glyph's dot bits.
+struct BrailleUtf8 {
+    char bytes[256][3];
+};
+
+constexpr BrailleUtf8 makeBrailleUtf8() {
+    BrailleUtf8 table{};
+    for (unsigned dots = 0; dots < 256; dots++) {
+        unsigned glyph = 0x2800 + dots;
+        table.bytes[dots][0] = static_cast<char>(0xe0 | (glyph >> 12));
+        table.bytes[dots][1] = static_cast<char>(0x80 | ((glyph >> 6) & 0x3f));
+        table.bytes[dots][2] = static_cast<char>(0x80 | (glyph & 0x3f));
+    }
+    return table;
+}
+
+inline constexpr BrailleUtf8 BRAILLE_UTF8 = makeBrailleUtf8();
+
+void appendMultibyteUtf8(std::string& out, char32_t glyph);
+
+// Appends glyph to out as UTF-8.
+inline void appendUtf8(std::string& out, char32_t glyph) {
+    if (glyph < 0x80) {
+        out += static_cast<char>(glyph);
+    } else if (glyph - 0x2800 < 0x100) {
+        out.append(BRAILLE_UTF8.bytes[glyph - 0x2800], 3);
+    } else {
+        appendMultibyteUtf8(out, glyph);
+    }
+}
+
+// Columns [begin, end) of a row written since the last clear; every cell
+// outside them is blank. Empty when begin >= end.
+struct RowExtent {
+    int begin;
+    int end;
+};
+
+// The whole screen as a grid of cells, drawn every frame and then emitted
+// as one string. Drawing outside the grid is clipped.
+//
+// Each row also keeps a hash of its contents, updated on every write from
+// the old and new value of the cell (Zobrist hashing), so comparing two
+// frames row by row does not have to read the cells of unchanged rows.
+// Together with the row extents and the list of rows written, this makes
+// clearing and diffing cost what was drawn rather than the size of the
+// screen.
+class Framebuffer {
+private:
+    int width;
+    int height;
+    std::vector<Cell> cells;
+    std::vector<std::uint64_t> rowHashes;
+    std::vector<RowExtent> extents;
+    std::vector<int> touched;       // rows with a non-empty extent
+    std::uint64_t blankRowHash;
+
+    static std::uint64_t cellHash(int x, Cell cell) {
+        // splitmix64 finaliser over the column and the cell
+        std::uint64_t z = ((static_cast<std::uint64_t>(x) << 32) | cell) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+public:
+    Framebuffer(int width, int height);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Fills every cell with a default-style space. Only the extents of
+    // the rows are written, so this costs what was drawn.
+    void clear();
+
+    // Changes the size and blanks every cell. Storage only grows: going
+    // back to a size that fitted before does not allocate.
+    void resize(int width, int height);
+
+    void put(int x, int y, char32_t glyph, Style style) {
+        if (x < 0 || x >= width || y < 0 || y >= height) return;
+        Cell cell = packCell(glyph, style);
+        Cell& slot = cells[static_cast<std::size_t>(y) * width + x];
+        if (slot != cell) {
+            rowHashes[y] ^= cellHash(x, slot) ^ cellHash(x, cell);
+            slot = cell;
+            RowExtent& extent = extents[y];
+            if (extent.begin >= extent.end) touched.push_back(y);
+            if (x < extent.begin) extent.begin = x;
+            if (x >= extent.end) extent.end = x + 1;
+        }
+    }
+
+    // Writes text from (x, y) to the end of the row; returns the column
+    // after the last character written.
+    int text(int x, int y, std::string_view text, Style style);
+
+    Cell at(int x, int y) const { return cells[static_cast<std::size_t>(y) * width + x]; }
+    const Cell* row(int y) const { return &cells[static_cast<std::size_t>(y) * width]; }
+    std::uint64_t rowHash(int y) const { return rowHashes[y]; }
+    RowExtent rowExtent(int y) const { return extents[y]; }
+    // Rows written since the last clear, in the order first written; all
+    // other rows are blank.
+    const std::vector<int>& touchedRows() const { return touched; }
+
+    // Appends the frame to out as text with the theme's escape sequences,
+    // for a terminal whose screen is blank with the cursor at the top left.
+    // Trailing blanks of each row are not written, and a sequence is only
+    // written where the visible style changes: spaces in a style that does
+    // not paint continue whatever run they are in. With overwrite the
+    // screen need not be blank: each row ends by erasing the rest of the
+    // line and the frame by erasing below it, so an old frame is replaced
+    // without first clearing to an empty screen. Returns the number of
+    // bytes appended.
+    std::size_t emit(std::string& out, const Theme& theme, bool overwrite = false) const;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+// Game objects
+struct Fruit {
+    std::string type;
+    char symbol;
+};
+
+struct Basket {
+    int x;
+    std::string type;
+    char symbol;
+};
@@ -0,0 +1,77 @@
+#include "json_arena.h"
+
+#include <cstdio>
+#include <memory>
+
+JsonArena::JsonArena(std::size_t initialBlockSize)
+    : used(0), nextBlockSize(initialBlockSize), allocationCount(0) {}
+
+JsonArena::~JsonArena() {
+    for (const Block& block : blocks) ::operator delete(block.data);
+}
+
+void JsonArena::grow(std::size_t minimum) {
+    std::size_t size = nextBlockSize;
+    while (size < minimum) size *= 2;
+    blocks.push_back(Block{static_cast<char*>(::operator new(size)), size});
+    used = 0;
+    nextBlockSize = size * 2;
+}
+
+void JsonArena::reset() {
+    if (blocks.empty()) return;
+    // Keep the newest block, which is also the largest
+    for (std::size_t i = 0; i + 1 < blocks.size(); i++) ::operator delete(blocks[i].data);
+    blocks.front() = blocks.back();
+    blocks.resize(1);
+    used = 0;
+    allocationCount = 0;
+}
+
+ArenaDocument::ArenaDocument(std::size_t initialBlockSize) : memory(initialBlockSize) {
+    clear();
+}
+
+void ArenaDocument::clear() {
+    memory.reset();
+    JsonArenaScope scope(memory);
+    rootValue = new (memory.allocate(sizeof(ArenaJson), alignof(ArenaJson))) ArenaJson();
+}
+
+bool ArenaDocument::parseFile(const std::string& path, std::string& error) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    clear();
+    JsonArenaScope scope(memory);
+    try {
+        *rootValue = ArenaJson::parse(file.get());
+    } catch (const ArenaJson::exception& ex) {
+        error = path + ": " + ex.what();
+        return false;
+    }
+    return true;
+}
+
+bool ArenaDocument::parse(const std::string& text, std::string& error) {
+    clear();
+    JsonArenaScope scope(memory);
+    try {
+        *rootValue = ArenaJson::parse(text);
+    } catch (const ArenaJson::exception& ex) {
+        error = ex.what();
+        return false;
+    }
+    return true;
+}
+
+// The one place the declarations at the end of json_arena.h are instantiated
+template class nlohmann::detail::lexer<ArenaJson, json_arena::StringAdapter>;
+template class nlohmann::detail::lexer<ArenaJson, json_arena::FileAdapter>;
+template class nlohmann::detail::parser<ArenaJson, json_arena::StringAdapter>;
+template class nlohmann::detail::parser<ArenaJson, json_arena::FileAdapter>;
+template class nlohmann::detail::serializer<ArenaJson>;
+template class nlohmann::detail::json_sax_dom_parser<ArenaJson>;
+template class nlohmann::detail::json_sax_dom_callback_parser<ArenaJson>;
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "json/json.hpp"
+
+// Monotonic arena for JSON documents. Allocation is a pointer bump and
+// deallocation is a no-op; reset() drops everything at once and keeps the
+// largest block for the next document.
+class JsonArena {
+private:
+    struct Block {
+        char* data;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t used;           // bytes used in blocks.back()
+    std::size_t nextBlockSize;
+    std::size_t allocationCount;
+
+    void grow(std::size_t minimum);
+
+public:
+    explicit JsonArena(std::size_t initialBlockSize = 64 * 1024);
+    ~JsonArena();
+    JsonArena(const JsonArena&) = delete;
+    JsonArena& operator=(const JsonArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment) {
+        if (!blocks.empty()) {
+            std::size_t offset = (used + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= blocks.back().size) {
+                used = offset + size;
+                allocationCount++;
+                return blocks.back().data + offset;
+            }
+        }
+        grow(size + alignment);
+        return allocate(size, alignment);
+    }
+
+    void reset();
+
+    std::size_t allocations() const { return allocationCount; }
+    std::size_t blockCount() const { return blocks.size(); }
+
+    // Arena that default-constructed ArenaAllocators on this thread use.
+    static JsonArena*& current() {
+        static thread_local JsonArena* arena = nullptr;
+        return arena;
+    }
+};
+
+// Makes an arena current for the enclosing scope.
+class JsonArenaScope {
+private:
+    JsonArena* previous;
+
+public:
+    explicit JsonArenaScope(JsonArena& arena) : previous(JsonArena::current()) {
+        JsonArena::current() = &arena;
+    }
+    ~JsonArenaScope() { JsonArena::current() = previous; }
+    JsonArenaScope(const JsonArenaScope&) = delete;
+    JsonArenaScope& operator=(const JsonArenaScope&) = delete;
+};
+
+// Allocator for basic_json's AllocatorType. basic_json default-constructs its
+// allocators, so the arena is picked up from JsonArena::current(); outside
+// any JsonArenaScope it falls back to the heap.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    JsonArena* arena;
+
+    ArenaAllocator() noexcept : arena(JsonArena::current()) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        if (arena) return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        if (!arena) ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+// basic_json whose nodes, arrays, objects and strings all live in a JsonArena.
+using ArenaJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool, std::int64_t,
+                                       std::uint64_t, double, ArenaAllocator>;
+
+// Parsing strings and files and dumping are compiled once, in json_arena.cpp
+namespace json_arena {
+
+using StringAdapter = nlohmann::detail::iterator_input_adapter<std::string::const_iterator>;
+using FileAdapter = nlohmann::detail::file_input_adapter;
+
+}  // namespace json_arena
+
+extern template class nlohmann::detail::lexer<ArenaJson, json_arena::StringAdapter>;
+extern template class nlohmann::detail::lexer<ArenaJson, json_arena::FileAdapter>;
+extern template class nlohmann::detail::parser<ArenaJson, json_arena::StringAdapter>;
+extern template class nlohmann::detail::parser<ArenaJson, json_arena::FileAdapter>;
+extern template class nlohmann::detail::serializer<ArenaJson>;
+extern template class nlohmann::detail::json_sax_dom_parser<ArenaJson>;
+extern template class nlohmann::detail::json_sax_dom_callback_parser<ArenaJson>;
+
+// An ArenaJson document together with its arena. The root is never
+// destroyed node by node: clear() releases the whole tree in one step.
+// Mutate the document inside a JsonArenaScope on arena().
+class ArenaDocument {
+private:
+    JsonArena memory;
+    ArenaJson* rootValue;
+
+public:
+    explicit ArenaDocument(std::size_t initialBlockSize = 64 * 1024);
+    ArenaDocument(const ArenaDocument&) = delete;
+    ArenaDocument& operator=(const ArenaDocument&) = delete;
+
+    JsonArena& arena() { return memory; }
+    ArenaJson& root() { return *rootValue; }
+
+    // Drops the current tree and starts over with a null root.
+    void clear();
+
+    bool parseFile(const std::string& path, std::string& error);
+    bool parse(const std::string& text, std::string& error);
+};
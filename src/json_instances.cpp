@@ -0,0 +1,13 @@
+#include "json_instances.h"
+
+// The one place the declarations in json_instances.h are instantiated.
+template class nlohmann::basic_json<>;
+template class nlohmann::detail::lexer<nlohmann::json, json_instances::StringAdapter>;
+template class nlohmann::detail::lexer<nlohmann::json, json_instances::FileAdapter>;
+template class nlohmann::detail::lexer<nlohmann::json, json_instances::StreamAdapter>;
+template class nlohmann::detail::parser<nlohmann::json, json_instances::StringAdapter>;
+template class nlohmann::detail::parser<nlohmann::json, json_instances::FileAdapter>;
+template class nlohmann::detail::parser<nlohmann::json, json_instances::StreamAdapter>;
+template class nlohmann::detail::serializer<nlohmann::json>;
+template class nlohmann::detail::json_sax_dom_parser<nlohmann::json>;
+template class nlohmann::detail::json_sax_dom_callback_parser<nlohmann::json>;
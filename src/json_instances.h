@@ -0,0 +1,34 @@
+#pragma once
+
+// Include this instead of json/json.hpp in units that build, query or dump
+// nlohmann::json documents. It declares the specialisations they use as
+// extern templates, so they are compiled once in json_instances.cpp
+// instead of in each of them. Seeing the declarations costs a unit about
+// as much as it saves when it makes little use of basic_json<>, so units
+// that only SAX-parse, or only use ArenaJson, include json/json.hpp.
+// ArenaJson's own lexer, parser and serializer are declared in
+// json_arena.h; the class itself cannot be instantiated whole, as
+// patch_inplace does not compile with a custom string type.
+
+#include <string>
+
+#include "json/json.hpp"
+
+namespace json_instances {
+
+using StringAdapter = nlohmann::detail::iterator_input_adapter<std::string::const_iterator>;
+using FileAdapter = nlohmann::detail::file_input_adapter;
+using StreamAdapter = nlohmann::detail::input_stream_adapter;
+
+}  // namespace json_instances
+
+extern template class nlohmann::basic_json<>;
+extern template class nlohmann::detail::lexer<nlohmann::json, json_instances::StringAdapter>;
+extern template class nlohmann::detail::lexer<nlohmann::json, json_instances::FileAdapter>;
+extern template class nlohmann::detail::lexer<nlohmann::json, json_instances::StreamAdapter>;
+extern template class nlohmann::detail::parser<nlohmann::json, json_instances::StringAdapter>;
+extern template class nlohmann::detail::parser<nlohmann::json, json_instances::FileAdapter>;
+extern template class nlohmann::detail::parser<nlohmann::json, json_instances::StreamAdapter>;
+extern template class nlohmann::detail::serializer<nlohmann::json>;
+extern template class nlohmann::detail::json_sax_dom_parser<nlohmann::json>;
+extern template class nlohmann::detail::json_sax_dom_callback_parser<nlohmann::json>;
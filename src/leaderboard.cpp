@@ -0,0 +1,400 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util.h"
+
+namespace {
+
+const char LEADERBOARD_MAGIC[8] = {'F', 'R', 'U', 'I', 'T', 'L', 'B', '1'};
+
+// First record of the file; same size as a ScoreEntry so records stay aligned.
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t count;
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == sizeof(ScoreEntry), "header must fill one record");
+
+// Higher score first; on ties the earlier score wins.
+bool better(const ScoreEntry& a, const ScoreEntry& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.timestamp < b.timestamp;
+}
+
+std::string pendingPathOf(const std::string& path) {
+    return path + ".pending";
+}
+
+// Reads the records in a side file; a missing one holds none
+bool readPending(const std::string& pendingPath, std::vector<ScoreEntry>& entries, std::string& error) {
+    entries.clear();
+    int fd = ::open(pendingPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return true;
+        error = "cannot open " + pendingPath;
+        return false;
+    }
+    struct stat info {};
+    bool ok = fstat(fd, &info) == 0;
+    if (ok) {
+        entries.resize(info.st_size / sizeof(ScoreEntry));
+        std::size_t bytes = entries.size() * sizeof(ScoreEntry);
+        ok = static_cast<std::size_t>(pread(fd, entries.data(), bytes, 0)) == bytes;
+        // A record cut short by a crash mid-append is cut off, or the next
+        // append would land out of step with the records
+        if (ok && static_cast<std::size_t>(info.st_size) != bytes) ok = truncate(pendingPath.c_str(), bytes) == 0;
+    }
+    ::close(fd);
+    if (!ok) error = "cannot read " + pendingPath;
+    return ok;
+}
+
+struct Range {
+    const ScoreEntry* first;
+    const ScoreEntry* last;
+};
+
+// Position of the first entry not strictly better than score.
+const ScoreEntry* splitPoint(const Range& range, std::int64_t score) {
+    return std::partition_point(range.first, range.last,
+                                [score](const ScoreEntry& e) { return e.score > score; });
+}
+
+// Whether range holds entry: same score, time and player
+bool holds(const Range& range, const ScoreEntry& entry) {
+    auto same = std::equal_range(range.first, range.last, entry, better);
+    return std::any_of(same.first, same.second, [&](const ScoreEntry& e) {
+        return std::memcmp(e.player, entry.player, PLAYER_NAME_SIZE) == 0;
+    });
+}
+
+// Writes the merge of two sorted ranges to path via a temporary file, so
+// readers of the old file never see a partial one.
+bool writeMerged(const std::string& path, Range a, Range b, std::string& error) {
+    std::string tmpPath = path + ".tmp";
+    FILE* out = std::fopen(tmpPath.c_str(), "wb");
+    if (!out) {
+        error = "cannot write " + tmpPath;
+        return false;
+    }
+    std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    FileHeader header{};
+    std::memcpy(header.magic, LEADERBOARD_MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.recordSize = sizeof(ScoreEntry);
+    header.count = (a.last - a.first) + (b.last - b.first);
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+
+    while (ok && (a.first != a.last || b.first != b.last)) {
+        const ScoreEntry* next;
+        if (b.first == b.last || (a.first != a.last && !better(*b.first, *a.first))) {
+            next = a.first++;
+        } else {
+            next = b.first++;
+        }
+        ok = std::fwrite(next, sizeof(ScoreEntry), 1, out) == 1;
+    }
+
+    ok = std::fflush(out) == 0 && ok;
+    ok = fsync(fileno(out)) == 0 && ok;
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        error = "failed writing " + path;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+MappedLeaderboard::MappedLeaderboard() : base(nullptr), length(0), entries(nullptr), count(0) {}
+
+MappedLeaderboard::~MappedLeaderboard() {
+    if (base) munmap(base, length);
+}
+
+bool MappedLeaderboard::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        error = path + " is not a leaderboard file";
+        return false;
+    }
+    length = info.st_size;
+    base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        base = nullptr;
+        error = "cannot map " + path;
+        return false;
+    }
+    // Lookups are binary searches, so readahead would only waste page cache
+    madvise(base, length, MADV_RANDOM);
+
+    const FileHeader* header = static_cast<const FileHeader*>(base);
+    if (std::memcmp(header->magic, LEADERBOARD_MAGIC, sizeof(header->magic)) != 0 ||
+        header->recordSize != sizeof(ScoreEntry) ||
+        (header->count + 1) * sizeof(ScoreEntry) != length) {
+        error = path + " is corrupt";
+        return false;
+    }
+    entries = reinterpret_cast<const ScoreEntry*>(header + 1);
+    count = header->count;
+    return true;
+}
+
+Leaderboard::Leaderboard(const std::string& path, std::size_t mergeThreshold)
+    : path(path), pendingPath(pendingPathOf(path)), mergeThreshold(mergeThreshold),
+      file(std::make_unique<MappedLeaderboard>()), pendingFd(-1), stopping(false), mergeRequested(false) {}
+
+Leaderboard::~Leaderboard() {
+    // Whatever is not merged yet is in the side file already
+    if (merger.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        merger.join();
+    }
+    if (pendingFd >= 0) ::close(pendingFd);
+}
+
+bool Leaderboard::open(std::string& error) {
+    if (access(path.c_str(), F_OK) != 0 && !build(path, {}, error)) {
+        return false;
+    }
+    auto mapped = std::make_unique<MappedLeaderboard>();
+    if (!mapped->open(path, error) || !loadPending(*mapped, error)) return false;
+    pendingFd = ::open(pendingPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (pendingFd < 0) {
+        error = "cannot open " + pendingPath;
+        return false;
+    }
+    file = std::move(mapped);
+    mergeRequested = pending.size() >= mergeThreshold;
+    merger = std::thread(&Leaderboard::mergeLoop, this);
+    return true;
+}
+
+bool Leaderboard::loadPending(const MappedLeaderboard& merged, std::string& error) {
+    std::vector<ScoreEntry> entries;
+    if (!readPending(pendingPath, entries, error)) return false;
+
+    // A merge that finished just before a crash leaves its scores in both
+    Range all{merged.begin(), merged.end()};
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&](const ScoreEntry& entry) { return holds(all, entry); }),
+                  entries.end());
+    std::sort(entries.begin(), entries.end(), better);
+    pending.swap(entries);
+    return true;
+}
+
+void Leaderboard::mergeLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || mergeRequested; });
+        if (stopping) break;
+        mergeRequested = false;
+
+        lock.unlock();
+        std::string error;
+        if (!mergePending(error)) std::cerr << "leaderboard: " << error << "\n";
+        lock.lock();
+    }
+}
+
+bool Leaderboard::mergePending(std::string& error) {
+    std::lock_guard<std::mutex> serialize(mergeMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) return true;
+        merging.swap(pending);
+    }
+
+    // Only this function replaces file, and it is serialized, so the mapping
+    // can be read here without holding the query lock.
+    Range a{file->begin(), file->end()};
+    Range b{merging.data(), merging.data() + merging.size()};
+    auto mapped = std::make_unique<MappedLeaderboard>();
+    bool ok = writeMerged(path, a, b, error) && mapped->open(path, error);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ok) {
+        // Keep the scores buffered so the next merge can retry
+        std::vector<ScoreEntry> restored(merging.size() + pending.size());
+        std::merge(merging.begin(), merging.end(), pending.begin(), pending.end(),
+                   restored.begin(), better);
+        pending.swap(restored);
+        merging.clear();
+        return false;
+    }
+    file = std::move(mapped);
+    merging.clear();
+    // Until this succeeds the side file still holds the merged scores too,
+    // and loadPending drops them
+    return rewritePending(error);
+}
+
+// Replaces the side file with the scores still pending. Called with the
+// lock held, so no submit appends to the old one meanwhile.
+bool Leaderboard::rewritePending(std::string& error) {
+    std::string tmpPath = pendingPath + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && writeAll(fd, pending.data(), pending.size() * sizeof(ScoreEntry)) && fsync(fd) == 0 &&
+              std::rename(tmpPath.c_str(), pendingPath.c_str()) == 0;
+    if (!ok) {
+        if (fd >= 0) ::close(fd);
+        std::remove(tmpPath.c_str());
+        error = "failed writing " + pendingPath;
+        return false;
+    }
+    if (pendingFd >= 0) ::close(pendingFd);
+    pendingFd = fd;
+    return true;
+}
+
+void Leaderboard::submit(const ScoreEntry& entry) {
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.insert(std::upper_bound(pending.begin(), pending.end(), entry, better), entry);
+        if (pendingFd >= 0 && !writeAll(pendingFd, &entry, sizeof(entry))) {
+            std::cerr << "leaderboard: cannot append to " << pendingPath << "\n";
+        }
+        if (pending.size() >= mergeThreshold && !mergeRequested) {
+            mergeRequested = true;
+            notify = true;
+        }
+    }
+    if (notify) wake.notify_one();
+}
+
+std::vector<ScoreEntry> Leaderboard::top(std::size_t k) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Range sources[] = {
+        {file->begin(), file->end()},
+        {merging.data(), merging.data() + merging.size()},
+        {pending.data(), pending.data() + pending.size()},
+    };
+
+    std::vector<ScoreEntry> result;
+    while (result.size() < k) {
+        Range* best = nullptr;
+        for (Range& source : sources) {
+            if (source.first != source.last && (!best || better(*source.first, *best->first))) {
+                best = &source;
+            }
+        }
+        if (!best) break;
+        result.push_back(*best->first++);
+    }
+    return result;
+}
+
+std::uint64_t Leaderboard::rankOf(std::int64_t score) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Range sources[] = {
+        {file->begin(), file->end()},
+        {merging.data(), merging.data() + merging.size()},
+        {pending.data(), pending.data() + pending.size()},
+    };
+
+    std::uint64_t ahead = 0;
+    for (const Range& source : sources) {
+        ahead += splitPoint(source, score) - source.first;
+    }
+    return ahead + 1;
+}
+
+std::vector<ScoreEntry> Leaderboard::around(std::int64_t score, std::size_t radius) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Range sources[] = {
+        {file->begin(), file->end()},
+        {merging.data(), merging.data() + merging.size()},
+        {pending.data(), pending.data() + pending.size()},
+    };
+
+    // Walk outwards from the split point of every source: backwards for the
+    // entries ranked just above, forwards for the ones at or below.
+    Range above[3];
+    Range below[3];
+    for (int i = 0; i < 3; i++) {
+        const ScoreEntry* split = splitPoint(sources[i], score);
+        above[i] = {sources[i].first, split};
+        below[i] = {split, sources[i].last};
+    }
+
+    std::vector<ScoreEntry> result;
+    while (result.size() < radius) {
+        Range* worst = nullptr;
+        for (Range& range : above) {
+            if (range.first != range.last &&
+                (!worst || better(*(worst->last - 1), *(range.last - 1)))) {
+                worst = &range;
+            }
+        }
+        if (!worst) break;
+        result.push_back(*--worst->last);
+    }
+    std::reverse(result.begin(), result.end());
+
+    for (std::size_t taken = 0; taken < radius; taken++) {
+        Range* best = nullptr;
+        for (Range& range : below) {
+            if (range.first != range.last && (!best || better(*range.first, *best->first))) {
+                best = &range;
+            }
+        }
+        if (!best) break;
+        result.push_back(*best->first++);
+    }
+    return result;
+}
+
+std::uint64_t Leaderboard::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file->size() + merging.size() + pending.size();
+}
+
+bool Leaderboard::flush(std::string& error) {
+    return mergePending(error);
+}
+
+bool Leaderboard::build(const std::string& path, std::vector<ScoreEntry> entries,
+                        std::string& error) {
+    std::sort(entries.begin(), entries.end(), better);
+    std::string pendingPath = pendingPathOf(path);
+    std::vector<ScoreEntry> unmerged;
+    if (!readPending(pendingPath, unmerged, error)) return false;
+    Range all{entries.data(), entries.data() + entries.size()};
+    unmerged.erase(std::remove_if(unmerged.begin(), unmerged.end(),
+                                  [&](const ScoreEntry& entry) { return holds(all, entry); }),
+                   unmerged.end());
+    std::sort(unmerged.begin(), unmerged.end(), better);
+    if (!writeMerged(path, all, Range{unmerged.data(), unmerged.data() + unmerged.size()}, error)) {
+        return false;
+    }
+    std::remove(pendingPath.c_str());
+    return true;
+}
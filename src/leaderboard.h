@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "records.h"
+
+// Read-only memory mapping of a leaderboard file: a header record followed by
+// ScoreEntry records sorted best first.
+class MappedLeaderboard {
+private:
+    void* base;
+    std::size_t length;
+    const ScoreEntry* entries;
+    std::uint64_t count;
+
+public:
+    MappedLeaderboard();
+    ~MappedLeaderboard();
+    MappedLeaderboard(const MappedLeaderboard&) = delete;
+    MappedLeaderboard& operator=(const MappedLeaderboard&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+
+    const ScoreEntry* begin() const { return entries; }
+    const ScoreEntry* end() const { return entries + count; }
+    std::uint64_t size() const { return count; }
+};
+
+// Persistent leaderboard. Entries live in a sorted, fixed-record file that is
+// memory-mapped on open, so startup only touches the header. New scores go to
+// a small sorted in-memory buffer, and are appended as raw records to a side
+// file (path + ".pending") read back into the buffer on open, so exiting
+// costs nothing. A background thread merges the buffer into a new file once
+// it holds mergeThreshold entries. All queries are answered from the file and
+// the buffers together in O(log n + k).
+class Leaderboard {
+private:
+    std::string path;
+    std::string pendingPath;
+    std::size_t mergeThreshold;
+
+    std::mutex mergeMutex;              // serializes merges
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::unique_ptr<MappedLeaderboard> file;
+    std::vector<ScoreEntry> merging;    // buffer currently being written out
+    std::vector<ScoreEntry> pending;    // sorted, not yet merged
+    int pendingFd;                      // side file, appended to by submit
+    bool stopping;
+    bool mergeRequested;
+    std::thread merger;
+
+    void mergeLoop();
+    bool mergePending(std::string& error);
+    bool loadPending(const MappedLeaderboard& merged, std::string& error);
+    bool rewritePending(std::string& error);
+
+public:
+    explicit Leaderboard(const std::string& path, std::size_t mergeThreshold = 4096);
+    ~Leaderboard();
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Maps the file, creating an empty one if needed, reads back the scores
+    // left in the side file and starts the merger.
+    bool open(std::string& error);
+
+    void submit(const ScoreEntry& entry);
+
+    // Best k entries, best first.
+    std::vector<ScoreEntry> top(std::size_t k) const;
+
+    // 1-based rank a score has: one more than the number of strictly better scores.
+    std::uint64_t rankOf(std::int64_t score) const;
+
+    // Up to radius entries on each side of where score ranks, best first.
+    std::vector<ScoreEntry> around(std::int64_t score, std::size_t radius) const;
+
+    std::uint64_t size() const;
+
+    // Merges everything buffered so far into the file before returning.
+    bool flush(std::string& error);
+
+    // Writes entries as a complete leaderboard file, replacing path. Scores
+    // still in its side file are merged in rather than lost, and the side
+    // file removed. Not safe while a Leaderboard has path open.
+    static bool build(const std::string& path, std::vector<ScoreEntry> entries,
+                      std::string& error);
+};
@@ -0,0 +1,99 @@
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+const std::uint64_t EVENTS[4] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+const char* const EVENT_NAMES[4] = {"cycles", "instructions", "cache-misses", "branch-misses"};
+
+int openEvent(std::uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // The group starts disabled and is enabled as a whole once complete
+    attr.disabled = groupFd < 0;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() : leader(-1), members{-1, -1, -1} {}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+bool PerfCounters::open(std::string& error) {
+    close();
+    for (int i = 0; i < 4; i++) {
+        int fd = openEvent(EVENTS[i], leader);
+        if (fd < 0) {
+            error = std::string("perf_event_open ") + EVENT_NAMES[i] + ": " + std::strerror(errno);
+            close();
+            return false;
+        }
+        if (i == 0) {
+            leader = fd;
+        } else {
+            members[i - 1] = fd;
+        }
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::close() {
+    for (int& fd : members) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    if (leader >= 0) ::close(leader);
+    leader = -1;
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+    if (leader < 0) return sample;
+    // PERF_FORMAT_GROUP: the member count, then one value per event in the
+    // order they were opened
+    std::uint64_t values[1 + 4];
+    if (::read(leader, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) return sample;
+    sample.cycles = values[1];
+    sample.instructions = values[2];
+    sample.cacheMisses = values[3];
+    sample.branchMisses = values[4];
+    return sample;
+}
+
+void appendPerfPhase(std::string& out, const char* phase, const PerfSample& sample) {
+    double ipc = sample.cycles ? static_cast<double>(sample.instructions) / sample.cycles : 0;
+    double kinstr = sample.instructions / 1000.0;
+    double cacheMissRate = kinstr > 0 ? sample.cacheMisses / kinstr : 0;
+    // Branch instructions are not counted, so misses are per instruction
+    double branchMissRate = sample.instructions ? 100.0 * sample.branchMisses / sample.instructions : 0;
+    char line[128];
+    int length = std::snprintf(line, sizeof(line),
+                               "%-9s IPC %.2f  cache miss %.2f/kinstr  branch miss %.2f%%/instr",
+                               phase, ipc, cacheMissRate, branchMissRate);
+    out.append(line, std::min<std::size_t>(length, sizeof(line) - 1));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Hardware counter values, or the difference between two reads.
+struct PerfSample {
+    std::uint64_t cycles = 0;
+    std::uint64_t instructions = 0;
+    std::uint64_t cacheMisses = 0;
+    std::uint64_t branchMisses = 0;
+
+    PerfSample& operator+=(const PerfSample& other) {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        cacheMisses += other.cacheMisses;
+        branchMisses += other.branchMisses;
+        return *this;
+    }
+
+    PerfSample operator-(const PerfSample& other) const {
+        PerfSample result;
+        result.cycles = cycles - other.cycles;
+        result.instructions = instructions - other.instructions;
+        result.cacheMisses = cacheMisses - other.cacheMisses;
+        result.branchMisses = branchMisses - other.branchMisses;
+        return result;
+    }
+};
+
+// Cycles, instructions, cache misses and branch misses of the calling
+// thread, in user space only, opened as one perf_event_open group so all
+// four count over exactly the same instructions. read() is one system call;
+// take a read before and after a phase and accumulate the difference.
+class PerfCounters {
+private:
+    int leader;
+    int members[3];
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Fails when the kernel or hypervisor does not expose the hardware
+    // counters, or perf_event_paranoid forbids them.
+    bool open(std::string& error);
+    void close();
+    bool isOpen() const { return leader >= 0; }
+
+    // Running totals since open(); all zero if the counters are not open.
+    PerfSample read() const;
+};
+
+// Appends one line per phase, without the newline, e.g.
+// "render    IPC 1.84  cache miss 0.31/kinstr  branch miss 0.52%/instr".
+// Only allocates if out has to grow.
+void appendPerfPhase(std::string& out, const char* phase, const PerfSample& sample);
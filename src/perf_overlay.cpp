@@ -0,0 +1,104 @@
+#include "perf_overlay.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+// Appends into [out, end) and returns the new end; stops quietly when full.
+char* append(char* out, char* end, const char* literal) {
+    std::size_t length = std::strlen(literal);
+    if (length > static_cast<std::size_t>(end - out)) length = end - out;
+    std::memcpy(out, literal, length);
+    return out + length;
+}
+
+char* append(char* out, char* end, std::uint32_t value) {
+    std::to_chars_result result = std::to_chars(out, end, value);
+    return result.ec == std::errc() ? result.ptr : out;
+}
+
+char* append(char* out, char* end, double value, int precision) {
+    std::to_chars_result result = std::to_chars(out, end, value, std::chars_format::fixed, precision);
+    return result.ec == std::errc() ? result.ptr : out;
+}
+
+double toMs(std::uint32_t ns) {
+    return ns / 1e6;
+}
+
+}  // namespace
+
+PerfOverlay::PerfOverlay(bool countsAllocations)
+    : entities(0), sinceSentNs(0), droppedFrames(0), countsAllocations(countsAllocations), timing{},
+      load{}, visible(false) {}
+
+void PerfOverlay::recordFrame(const OverlayFrame& frame) {
+    if (frame.intervalNs > 0) frameNs.push(frame.intervalNs);
+    tickNs.push(frame.tickNs);
+    renderNs.push(frame.renderNs);
+    renderBytes.push(frame.bytes);
+    if (frame.inputLatencyNs > 0) inputNs.push(frame.inputLatencyNs);
+    allocations.push(frame.allocations);
+    entities = frame.entities;
+    sinceSentNs += frame.intervalNs;
+    if (frame.dropped) {
+        droppedFrames++;
+    } else {
+        if (sinceSentNs > 0) sentNs.push(sinceSentNs);
+        sinceSentNs = 0;
+    }
+}
+
+std::string_view PerfOverlay::format() {
+    if (!visible) return std::string_view();
+    char* out = timing;
+    char* end = timing + sizeof(timing);
+
+    std::uint32_t interval = frameNs.mean();
+    out = append(out, end, "  | ");
+    out = append(out, end, interval ? 1e9 / interval : 0.0, 1);
+    out = append(out, end, " fps  tick ");
+    out = append(out, end, toMs(tickNs.mean()), 2);
+    out = append(out, end, "/");
+    out = append(out, end, toMs(tickNs.max()), 2);
+    out = append(out, end, "  draw ");
+    out = append(out, end, toMs(renderNs.mean()), 2);
+    out = append(out, end, "/");
+    out = append(out, end, toMs(renderNs.max()), 2);
+    out = append(out, end, " ms");
+    if (inputNs.size() > 0) {
+        out = append(out, end, "  input ");
+        out = append(out, end, toMs(inputNs.percentile(0.5)), 1);
+        out = append(out, end, "/");
+        out = append(out, end, toMs(inputNs.percentile(0.99)), 1);
+        out = append(out, end, " ms");
+    }
+    return std::string_view(timing, out - timing);
+}
+
+std::string_view PerfOverlay::formatLoad() {
+    if (!visible) return std::string_view();
+    char* out = load;
+    char* end = load + sizeof(load);
+
+    out = append(out, end, "  | ");
+    out = append(out, end, renderBytes.mean());
+    out = append(out, end, " B  ");
+    out = append(out, end, entities);
+    out = append(out, end, " entities");
+    if (countsAllocations) {
+        out = append(out, end, "  ");
+        out = append(out, end, allocations.max());
+        out = append(out, end, " allocs");
+    }
+    if (droppedFrames > 0) {
+        std::uint32_t sentInterval = sentNs.mean();
+        out = append(out, end, "  sent ");
+        out = append(out, end, sentInterval ? 1e9 / sentInterval : 0.0, 1);
+        out = append(out, end, "/s, ");
+        out = append(out, end, droppedFrames);
+        out = append(out, end, " dropped");
+    }
+    return std::string_view(load, out - load);
+}
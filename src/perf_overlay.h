@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The last N values of one metric. One thread pushes; any thread may read
+// the summary at any time without locks. A reader racing a push can see a
+// mix of the old and new window, which only shifts the summary by one
+// sample.
+template<std::size_t N>
+class RollingWindow {
+private:
+    std::atomic<std::uint32_t> values[N];
+    std::atomic<std::uint64_t> count;
+
+public:
+    RollingWindow() : count(0) {
+        for (auto& value : values) value.store(0, std::memory_order_relaxed);
+    }
+
+    void push(std::uint32_t value) {
+        std::uint64_t n = count.load(std::memory_order_relaxed);
+        values[n % N].store(value, std::memory_order_relaxed);
+        count.store(n + 1, std::memory_order_release);
+    }
+
+    std::size_t size() const {
+        std::uint64_t n = count.load(std::memory_order_acquire);
+        return n < N ? static_cast<std::size_t>(n) : N;
+    }
+
+    // 0 while empty.
+    std::uint32_t mean() const {
+        std::size_t n = size();
+        if (n == 0) return 0;
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < n; i++) sum += values[i].load(std::memory_order_relaxed);
+        return static_cast<std::uint32_t>(sum / n);
+    }
+
+    // The value a fraction q (0 to 1) of the way up the sorted window, 0
+    // while empty. Sorts a copy on the stack, so it does not allocate.
+    std::uint32_t percentile(double q) const {
+        std::size_t n = size();
+        if (n == 0) return 0;
+        std::uint32_t sorted[N];
+        for (std::size_t i = 0; i < n; i++) sorted[i] = values[i].load(std::memory_order_relaxed);
+        std::size_t k = static_cast<std::size_t>(q * (n - 1) + 0.5);
+        std::nth_element(sorted, sorted + k, sorted + n);
+        return sorted[k];
+    }
+
+    std::uint32_t max() const {
+        std::size_t n = size();
+        std::uint32_t result = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            std::uint32_t value = values[i].load(std::memory_order_relaxed);
+            if (value > result) result = value;
+        }
+        return result;
+    }
+};
+
+// What the game loop measured for one frame.
+struct OverlayFrame {
+    std::uint32_t intervalNs;       // since the previous frame started, 0 for the first
+    std::uint32_t tickNs;           // the fixed-step updates
+    std::uint32_t renderNs;         // drawing and sending the frame
+    std::uint32_t bytes;            // sent for the frame
+    std::uint32_t inputLatencyNs;   // key read to the frame showing it, 0 if none
+    std::uint32_t entities;         // baskets and falling fruit
+    std::uint32_t allocations;      // heap allocations during the frame
+    bool dropped;                   // not sent because the output was backed up
+};
+
+// Live performance readout shown next to the status lines, toggled in
+// game. The text is formatted with std::to_chars into fixed buffers owned
+// by the overlay, so drawing it does not allocate.
+class PerfOverlay {
+private:
+    static const std::size_t WINDOW = 64;
+
+    RollingWindow<WINDOW> frameNs;      // start of one frame to the next
+    RollingWindow<WINDOW> tickNs;
+    RollingWindow<WINDOW> renderNs;
+    RollingWindow<WINDOW> renderBytes;
+    RollingWindow<WINDOW> inputNs;      // only frames that showed a key press
+    RollingWindow<WINDOW> sentNs;       // one frame sent to the next
+    RollingWindow<WINDOW> allocations;
+    std::uint32_t entities;
+    std::uint32_t sinceSentNs;
+    std::uint32_t droppedFrames;
+    bool countsAllocations;
+    char timing[128];
+    char load[128];
+    bool visible;
+
+public:
+    // Allocations are only shown when countsAllocations, as they read 0
+    // in builds that do not track them.
+    explicit PerfOverlay(bool countsAllocations = false);
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+
+    void recordFrame(const OverlayFrame& frame);
+
+    // Frame rate, tick and draw time (mean/max) and input latency (median
+    // and 99th percentile), empty when hidden:
+    // "  | 60.0 fps  tick 0.02/0.05  draw 0.31/0.90 ms  input 12.3/40.1 ms".
+    // Valid until the next call.
+    std::string_view format();
+
+    // Bytes sent per frame, live entities and the most heap allocations in
+    // a recent frame, empty when hidden: "  | 1702 B  5 entities  0 allocs".
+    // Once frames were dropped it adds the rate of frames sent, as in
+    // "  sent 12.5/s, 340 dropped". Valid until the next call.
+    std::string_view formatLoad();
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "json/json.hpp"
+#include "save_data.h"
+
+// Profile <-> json conversion shared by the whole-file saver (ArenaJson,
+// call inside a JsonArenaScope) and the journaled store (nlohmann::json).
+
+template<typename Json>
+void sessionToJson(const SessionRecord& session, Json& item) {
+    item["time"] = session.timestamp;
+    item["score"] = session.score;
+    item["caught"] = session.caught;
+    item["missed"] = session.missed;
+    item["duration_ms"] = session.durationMs;
+    item["mode"] = gameModeName(session.mode);
+}
+
+template<typename Json>
+void profileToJson(const Profile& profile, Json& root) {
+    root["player"] = profile.player.c_str();
+    root["games"] = profile.gamesPlayed;
+    root["best_score"] = profile.bestScore;
+    root["caught"] = profile.totalCaught;
+    root["missed"] = profile.totalMissed;
+    Json& achievements = root["achievements"] = Json::array();
+    for (const auto& name : profile.achievements) achievements.push_back(name.c_str());
+
+    Json& history = root["history"] = Json::array();
+    for (const auto& session : profile.history) {
+        Json item = Json::object();
+        sessionToJson(session, item);
+        history.push_back(std::move(item));
+    }
+}
+
+template<typename Json>
+bool profileFromJson(const Json& root, Profile& out, std::string& error) {
+    using String = typename Json::string_t;
+    out = Profile{"player", 0, 0, 0, 0, {}, {}};
+    try {
+        out.player = root.value("player", String("player")).c_str();
+        out.gamesPlayed = root.value("games", 0);
+        out.bestScore = root.value("best_score", std::int64_t(0));
+        out.totalCaught = root.value("caught", std::int64_t(0));
+        out.totalMissed = root.value("missed", std::int64_t(0));
+        if (root.contains("achievements")) {
+            for (const auto& name : root["achievements"]) {
+                out.achievements.emplace_back(name.template get_ref<const String&>().c_str());
+            }
+        }
+        if (root.contains("history")) {
+            out.history.reserve(root["history"].size());
+            for (const auto& item : root["history"]) {
+                SessionRecord session{};
+                session.timestamp = item.value("time", std::int64_t(0));
+                session.score = item.value("score", 0);
+                session.caught = item.value("caught", 0);
+                session.missed = item.value("missed", 0);
+                session.durationMs = item.value("duration_ms", 0);
+                parseGameMode(item.value("mode", String("classic")).c_str(), session.mode);
+                out.history.push_back(session);
+            }
+        }
+    } catch (const typename Json::exception& ex) {
+        error = ex.what();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,273 @@
+#include "profile_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+#include "json_instances.h"
+#include "profile_json.h"
+
+namespace {
+
+using json = nlohmann::json;
+
+bool syncFile(FILE* file) {
+    return std::fflush(file) == 0 && fdatasync(fileno(file)) == 0;
+}
+
+// Appended to the files of a profile that failed to load
+const char* const BAD_SUFFIX = ".bad";
+
+// Renames path to path + BAD_SUFFIX; true if it is not there either
+bool setAside(const std::string& path) {
+    return std::rename(path.c_str(), (path + BAD_SUFFIX).c_str()) == 0 || errno == ENOENT;
+}
+
+Profile freshProfile() {
+    return Profile{"player", 0, 0, 0, 0, {}, {}};
+}
+
+bool sameSession(const SessionRecord& a, const SessionRecord& b) {
+    return a.timestamp == b.timestamp && a.score == b.score && a.caught == b.caught &&
+           a.missed == b.missed && a.durationMs == b.durationMs && a.mode == b.mode;
+}
+
+// "add" sets an object member whether or not it exists
+void addOp(json& patch, const char* path, json value) {
+    patch.push_back({{"op", "add"}, {"path", path}, {"value", std::move(value)}});
+}
+
+// Whether before is where after starts, as when entries were only appended
+template<typename T, typename Same>
+bool isPrefix(const std::vector<T>& before, const std::vector<T>& after, Same same) {
+    return before.size() <= after.size() && std::equal(before.begin(), before.end(), after.begin(), same);
+}
+
+// The patch that turns before into after
+json profilePatch(const Profile& before, const Profile& after) {
+    json patch = json::array();
+    if (after.player != before.player) addOp(patch, "/player", after.player);
+    if (after.gamesPlayed != before.gamesPlayed) addOp(patch, "/games", after.gamesPlayed);
+    if (after.bestScore != before.bestScore) addOp(patch, "/best_score", after.bestScore);
+    if (after.totalCaught != before.totalCaught) addOp(patch, "/caught", after.totalCaught);
+    if (after.totalMissed != before.totalMissed) addOp(patch, "/missed", after.totalMissed);
+
+    auto sameName = [](const std::string& a, const std::string& b) { return a == b; };
+    if (isPrefix(before.achievements, after.achievements, sameName)) {
+        for (std::size_t i = before.achievements.size(); i < after.achievements.size(); i++) {
+            addOp(patch, "/achievements/-", after.achievements[i]);
+        }
+    } else {
+        addOp(patch, "/achievements", after.achievements);
+    }
+
+    if (isPrefix(before.history, after.history, sameSession)) {
+        for (std::size_t i = before.history.size(); i < after.history.size(); i++) {
+            json item = json::object();
+            sessionToJson(after.history[i], item);
+            addOp(patch, "/history/-", std::move(item));
+        }
+    } else {
+        // Rewritten rather than appended to: replace the whole history
+        json root = json::object();
+        profileToJson(after, root);
+        addOp(patch, "/history", std::move(root["history"]));
+    }
+    return patch;
+}
+
+}  // namespace
+
+ProfileStore::ProfileStore(const std::string& path, std::size_t compactThreshold)
+    : snapshotPath(path), journalPath(path + ".journal"), compactThreshold(compactThreshold),
+      persisted(freshProfile()), seq(0), journal(nullptr), journalBytes(0), damaged(false), compacting(false) {}
+
+ProfileStore::~ProfileStore() {
+    wait();
+    if (journal) std::fclose(journal);
+}
+
+bool ProfileStore::openJournal(std::string& error) {
+    if (journal) std::fclose(journal);
+    journal = std::fopen(journalPath.c_str(), "ab");
+    if (!journal) {
+        error = "cannot open " + journalPath;
+        return false;
+    }
+    std::fseek(journal, 0, SEEK_END);
+    journalBytes = std::ftell(journal);
+    return true;
+}
+
+bool ProfileStore::load(Profile& out, std::string& error) {
+    wait();
+    std::lock_guard<std::mutex> lock(mutex);
+    damaged = false;
+
+    // On failure the caller plays on with a fresh profile, and the store
+    // must diff later saves against that, not a half-loaded document. The
+    // files that failed are moved aside, so later saves start a new profile
+    // instead of appending behind data every load would stop at again.
+    auto fail = [&] {
+        out = freshProfile();
+        persisted = out;
+        seq = 0;
+        if (journal) std::fclose(journal);
+        journal = nullptr;
+        if (setAside(snapshotPath) && setAside(journalPath)) {
+            error += "; moved aside to " + snapshotPath + BAD_SUFFIX;
+            std::string ignored;
+            openJournal(ignored);
+        } else {
+            damaged = true;
+            error += "; not saving until it is moved aside";
+        }
+        return false;
+    };
+
+    json root;
+    std::ifstream snapshot(snapshotPath);
+    if (snapshot) {
+        root = json::parse(snapshot, nullptr, false);
+        if (root.is_discarded()) {
+            error = snapshotPath + " is not valid JSON";
+            return fail();
+        }
+    } else {
+        root = json::object();
+        profileToJson(freshProfile(), root);
+    }
+    seq = root.value("journal_seq", std::uint64_t(0));
+
+    std::ifstream in(journalPath);
+    std::string line;
+    long validBytes = 0;
+    bool torn = false;
+    while (std::getline(in, line)) {
+        // A torn last line from a crash mid-append ends the replay; a line
+        // without its newline was never synced either
+        json entry = json::parse(line, nullptr, false);
+        if (in.eof() || entry.is_discarded() || !entry.contains("seq") || !entry.contains("patch")) {
+            torn = true;
+            break;
+        }
+        validBytes += static_cast<long>(line.size()) + 1;
+        std::uint64_t lineSeq = entry["seq"].get<std::uint64_t>();
+        if (lineSeq <= seq) continue;
+        try {
+            root.patch_inplace(entry["patch"]);
+        } catch (const json::exception& ex) {
+            error = journalPath + ": " + ex.what();
+            return fail();
+        }
+        seq = lineSeq;
+    }
+    in.close();
+    // Cut the torn tail off, or the next save would append after it and
+    // be lost behind it on the following load
+    if (torn && truncate(journalPath.c_str(), validBytes) != 0) {
+        error = "cannot truncate " + journalPath;
+        return fail();
+    }
+
+    if (!profileFromJson(root, out, error)) {
+        error = snapshotPath + ": " + error;
+        return fail();
+    }
+    persisted = out;
+    return openJournal(error);
+}
+
+bool ProfileStore::save(const Profile& profile, std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (damaged) {
+            error = snapshotPath + " failed to load and could not be moved aside";
+            return false;
+        }
+        if (!journal && !openJournal(error)) return false;
+
+        json patch = profilePatch(persisted, profile);
+        if (patch.empty()) return true;
+
+        json entry = {{"seq", seq + 1}, {"patch", std::move(patch)}};
+        std::string line = entry.dump();
+        line += '\n';
+        if (std::fwrite(line.data(), 1, line.size(), journal) != line.size() || !syncFile(journal)) {
+            error = "cannot append to " + journalPath;
+            return false;
+        }
+        journalBytes += line.size();
+        seq++;
+        persisted = profile;
+
+        if (journalBytes < compactThreshold || compacting) return true;
+        compacting = true;
+    }
+    wait();
+    compactor = std::thread(&ProfileStore::compact, this);
+    return true;
+}
+
+void ProfileStore::compact() {
+    compactSnapshot();
+    compacting = false;
+}
+
+void ProfileStore::compactSnapshot() {
+    Profile profile;
+    std::uint64_t coveredSeq;
+    long coveredBytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        profile = persisted;
+        coveredSeq = seq;
+        coveredBytes = static_cast<long>(journalBytes);
+    }
+    json root = json::object();
+    profileToJson(profile, root);
+    root["journal_seq"] = coveredSeq;
+    std::string text = root.dump();
+    text += '\n';
+
+    std::string tmpPath = snapshotPath + ".tmp";
+    FILE* out = std::fopen(tmpPath.c_str(), "wb");
+    bool ok = out && std::fwrite(text.data(), 1, text.size(), out) == text.size() && syncFile(out);
+    if (out) ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(tmpPath.c_str(), snapshotPath.c_str()) != 0) {
+        std::cerr << "profile: cannot write snapshot " << snapshotPath << "\n";
+        return;
+    }
+
+    // Keep only journal lines appended after the snapshot was taken
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string journalTmp = journalPath + ".tmp";
+    {
+        std::ifstream in(journalPath, std::ios::binary);
+        std::ofstream tail(journalTmp, std::ios::binary | std::ios::trunc);
+        in.seekg(coveredBytes);
+        if (in.peek() != std::char_traits<char>::eof()) tail << in.rdbuf();
+        if (!tail) {
+            std::cerr << "profile: cannot trim journal " << journalPath << "\n";
+            return;
+        }
+    }
+    if (std::rename(journalTmp.c_str(), journalPath.c_str()) != 0) {
+        std::cerr << "profile: cannot trim journal " << journalPath << "\n";
+        return;
+    }
+    std::string error;
+    if (!openJournal(error)) std::cerr << "profile: " << error << "\n";
+}
+
+void ProfileStore::wait() {
+    if (compactor.joinable()) compactor.join();
+}
+
+std::size_t ProfileStore::journalSize() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return journalBytes;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "save_data.h"
+
+// Journaled profile persistence. The profile lives in a full snapshot
+// (path) plus a journal (path + ".journal") of JSON Patch documents, one per
+// line as {"seq": n, "patch": [...]}. A save compares the profile with the
+// last one saved and appends a patch built from the difference: new
+// sessions and achievements are added to the end of their arrays and
+// changed totals replaced, so its cost follows what changed rather than the
+// profile size. Once the journal passes compactThreshold bytes, a
+// background thread folds it into a new snapshot.
+//
+// The snapshot records the last sequence number it contains as
+// "journal_seq", so journal lines it already covers are skipped on load and
+// a crash between writing the snapshot and trimming the journal is harmless.
+// The snapshot is a regular profile and loadProfile() (save_files.h) reads
+// it as such.
+class ProfileStore {
+private:
+    std::string snapshotPath;
+    std::string journalPath;
+    std::size_t compactThreshold;
+
+    std::mutex mutex;
+    Profile persisted;                  // state as of the journal tail
+    std::uint64_t seq;
+    FILE* journal;
+    std::size_t journalBytes;
+    bool damaged;                       // failed to load and still in place
+    std::thread compactor;
+    std::atomic<bool> compacting;
+
+    bool openJournal(std::string& error);
+    void compact();
+    void compactSnapshot();
+
+public:
+    explicit ProfileStore(const std::string& path, std::size_t compactThreshold = 256 * 1024);
+    ~ProfileStore();
+    ProfileStore(const ProfileStore&) = delete;
+    ProfileStore& operator=(const ProfileStore&) = delete;
+
+    // Reads the snapshot and replays the journal. A missing profile loads as
+    // a fresh one. On failure out is a fresh profile, and the snapshot and
+    // journal are renamed with a ".bad" suffix so saves start over beside
+    // them; if they cannot be, saves fail instead.
+    bool load(Profile& out, std::string& error);
+
+    // Appends the change since the last save; a no-op if nothing changed.
+    bool save(const Profile& profile, std::string& error);
+
+    // Waits for a running compaction.
+    void wait();
+
+    std::size_t journalSize();
+};
@@ -0,0 +1,86 @@
+#include "profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+namespace profiler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // Taken once, when the registry is first used. Each export pairs it with
+    // the current tick and clock readings to convert timestamp() units to
+    // microseconds; trace times count from it.
+    std::uint64_t originTicks = timestamp();
+    Clock::time_point originTime = Clock::now();
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+}  // namespace
+
+ThreadBuffer::ThreadBuffer(std::uint32_t threadId)
+    : cursor(nullptr), chunkEnd(nullptr), count(0), threadId(threadId) {}
+
+void ThreadBuffer::addChunk() {
+    std::lock_guard<std::mutex> lock(chunksMutex);
+    chunks.emplace_back(new Chunk);
+    cursor = chunks.back()->events;
+    chunkEnd = cursor + CHUNK_EVENTS;
+}
+
+ThreadBuffer& registerThread() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.buffers.emplace_back(new ThreadBuffer(static_cast<std::uint32_t>(r.buffers.size())));
+    return *r.buffers.back();
+}
+
+bool exportTrace(const std::string& path, std::string& error) {
+    Registry& r = registry();
+    std::uint64_t nowTicks = timestamp();
+    double elapsedUs = std::chrono::duration<double, std::micro>(Clock::now() - r.originTime).count();
+    double usPerTick = nowTicks > r.originTicks ? elapsedUs / (nowTicks - r.originTicks) : 0;
+
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    int pid = static_cast<int>(getpid());
+    bool first = true;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& buffer : r.buffers) {
+        std::fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,"
+                     "\"args\":{\"name\":\"thread %u\"}}",
+                     first ? "" : ",", pid, buffer->id(), buffer->id());
+        first = false;
+        buffer->forEach([&](const ZoneEvent& event) {
+            // Events recorded before the origin was taken clamp to zero
+            double ts = event.start > r.originTicks ? (event.start - r.originTicks) * usPerTick : 0;
+            std::fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                         "\"pid\":%d,\"tid\":%u}",
+                         event.name, ts, (event.end - event.start) * usPerTick, pid, buffer->id());
+        });
+    }
+    std::fputs("\n]}\n", out);
+
+    if (std::fclose(out) != 0) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace profiler
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Scoped profiling zones exported in the Chrome trace_event format, which
+// chrome://tracing and Perfetto load directly.
+//
+//   void Game::drawGame() {
+//       PROFILE_ZONE("draw");
+//       ...
+//   }
+//
+// Zones are compiled in only when FRUIT_PROFILE is defined (make PROFILE=1);
+// otherwise PROFILE_ZONE expands to nothing. Each thread appends to its own
+// buffer, so an enabled zone is two timestamp reads and one store. Zone names
+// must be string literals: only the pointer is kept, and it is written to
+// the trace unescaped.
+
+namespace profiler {
+
+struct ZoneEvent {
+    const char* name;
+    std::uint64_t start;    // timestamp() units
+    std::uint64_t end;
+};
+
+inline std::uint64_t timestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Events of one thread, in fixed-size chunks so recording never moves or
+// copies earlier events. Only the owning thread appends; the exporter reads
+// up to the published count.
+class ThreadBuffer {
+private:
+    static const std::size_t CHUNK_EVENTS = 16384;
+
+    struct Chunk {
+        ZoneEvent events[CHUNK_EVENTS];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::mutex chunksMutex;             // guards the chunk list, not the events
+    ZoneEvent* cursor;
+    ZoneEvent* chunkEnd;
+    std::atomic<std::uint64_t> count;
+    std::uint32_t threadId;
+
+    void addChunk();
+
+public:
+    explicit ThreadBuffer(std::uint32_t threadId);
+
+    void record(const char* name, std::uint64_t start, std::uint64_t end) {
+        if (cursor == chunkEnd) addChunk();
+        *cursor++ = ZoneEvent{name, start, end};
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::uint32_t id() const { return threadId; }
+
+    // Calls f for every event published so far.
+    template<typename F>
+    void forEach(F f) {
+        std::uint64_t n = count.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(chunksMutex);
+        for (std::uint64_t i = 0; i < n; i++) f(chunks[i / CHUNK_EVENTS]->events[i % CHUNK_EVENTS]);
+    }
+};
+
+// Creates and registers a buffer for the calling thread. Buffers outlive
+// their threads so events of finished threads are still exported.
+ThreadBuffer& registerThread();
+
+inline thread_local ThreadBuffer* currentBuffer = nullptr;
+
+inline ThreadBuffer& threadBuffer() {
+    if (!currentBuffer) currentBuffer = &registerThread();
+    return *currentBuffer;
+}
+
+// Writes every zone recorded so far, from all threads, as trace_event JSON.
+// Safe to call while other threads keep recording.
+bool exportTrace(const std::string& path, std::string& error);
+
+class Zone {
+private:
+    const char* name;
+    std::uint64_t start;
+
+public:
+    explicit Zone(const char* name) : name(name), start(timestamp()) {}
+    ~Zone() { threadBuffer().record(name, start, timestamp()); }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+};
+
+}  // namespace profiler
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef FRUIT_PROFILE
+#define PROFILE_ZONE(name) ::profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) do {} while (0)
+#endif
@@ -0,0 +1,183 @@
+#include "record_loader.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+
+#include "json/json.hpp"
+
+namespace {
+
+using json = nlohmann::json;
+
+// SAX handler following the json_sax contract. Depth 1 is the root object,
+// depth 2 a section array, depth 3 a single record; anything deeper is skipped.
+class RecordSaxHandler : public nlohmann::json_sax<json> {
+private:
+    enum class Section { None, Leaderboard, History };
+    enum class Field { None, Player, Score, Time, Caught, Missed, Duration, Mode };
+
+    RecordSet& out;
+    std::string& error;
+    int depth;
+    Section section;
+    Field field;
+    ScoreEntry entry;
+    SessionRecord session;
+
+    void resetRecord() {
+        entry = ScoreEntry{};
+        session = SessionRecord{};
+    }
+
+    bool outOfRange() {
+        error = "number out of range in record " + std::to_string(
+            section == Section::Leaderboard ? out.leaderboard.size() : out.history.size());
+        return false;
+    }
+
+    // A number int64 cannot hold: an error where a field wants it, skipped
+    // anywhere else
+    bool unrepresentable() {
+        if (depth == 3 && field != Field::None) return outOfRange();
+        field = Field::None;
+        return true;
+    }
+
+    bool setNumber(std::int64_t value) {
+        if (depth != 3) return true;
+        // Session fields are 32-bit; scores are only 64-bit on the leaderboard
+        bool narrow = field == Field::Caught || field == Field::Missed || field == Field::Duration ||
+                      (field == Field::Score && section == Section::History);
+        if (narrow && (value < std::numeric_limits<std::int32_t>::min() ||
+                       value > std::numeric_limits<std::int32_t>::max())) {
+            return outOfRange();
+        }
+        switch (field) {
+            case Field::Score:
+                entry.score = value;
+                session.score = static_cast<std::int32_t>(value);
+                break;
+            case Field::Time:
+                entry.timestamp = value;
+                session.timestamp = value;
+                break;
+            case Field::Caught: session.caught = static_cast<std::int32_t>(value); break;
+            case Field::Missed: session.missed = static_cast<std::int32_t>(value); break;
+            case Field::Duration: session.durationMs = static_cast<std::int32_t>(value); break;
+            default: break;
+        }
+        field = Field::None;
+        return true;
+    }
+
+public:
+    RecordSaxHandler(RecordSet& out, std::string& error)
+        : out(out), error(error), depth(0), section(Section::None), field(Field::None) {
+        resetRecord();
+    }
+
+    bool null() override { field = Field::None; return true; }
+    bool boolean(bool) override { field = Field::None; return true; }
+    bool number_integer(number_integer_t val) override { return setNumber(val); }
+    bool number_unsigned(number_unsigned_t val) override {
+        if (val > static_cast<number_unsigned_t>(std::numeric_limits<std::int64_t>::max())) {
+            return unrepresentable();
+        }
+        return setNumber(static_cast<std::int64_t>(val));
+    }
+    bool number_float(number_float_t val, const string_t&) override {
+        // Converting a value int64 cannot hold is undefined; 2^63 itself is
+        // the first double out of range
+        if (!(std::isfinite(val) && val >= -0x1p63 && val < 0x1p63)) return unrepresentable();
+        return setNumber(static_cast<std::int64_t>(val));
+    }
+
+    bool string(string_t& val) override {
+        if (depth == 3) {
+            if (field == Field::Player) {
+                setPlayerName(entry, val);
+            } else if (field == Field::Mode) {
+                parseGameMode(val, session.mode);
+            }
+        }
+        field = Field::None;
+        return true;
+    }
+
+    bool binary(binary_t&) override { field = Field::None; return true; }
+
+    bool start_object(std::size_t) override {
+        depth++;
+        if (depth == 3) resetRecord();
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (depth == 1) {
+            if (val == "leaderboard") section = Section::Leaderboard;
+            else if (val == "history") section = Section::History;
+            else section = Section::None;
+        } else if (depth == 3) {
+            if (val == "player") field = Field::Player;
+            else if (val == "score") field = Field::Score;
+            else if (val == "time") field = Field::Time;
+            else if (val == "caught") field = Field::Caught;
+            else if (val == "missed") field = Field::Missed;
+            else if (val == "duration_ms") field = Field::Duration;
+            else if (val == "mode") field = Field::Mode;
+            else field = Field::None;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth == 3) {
+            if (section == Section::Leaderboard) out.leaderboard.push_back(entry);
+            else if (section == Section::History) out.history.push_back(session);
+        }
+        depth--;
+        field = Field::None;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        depth++;
+        field = Field::None;
+        return true;
+    }
+
+    bool end_array() override {
+        depth--;
+        if (depth == 1) section = Section::None;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&,
+                     const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        return false;
+    }
+};
+
+}  // namespace
+
+bool loadRecords(const std::string& path, RecordSet& out, std::string& error) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    // The file adapter pulls one byte at a time; a large stdio buffer keeps
+    // that cheap without holding more than 1 MiB of the file in memory.
+    std::setvbuf(file.get(), nullptr, _IOFBF, 1 << 20);
+
+    RecordSaxHandler handler(out, error);
+    return json::sax_parse(file.get(), &handler);
+}
+
+bool parseRecords(const std::string& text, RecordSet& out, std::string& error) {
+    RecordSaxHandler handler(out, error);
+    return json::sax_parse(text, &handler);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "records.h"
+
+// Leaderboard and play history loaded from a records file of the form
+//
+//   {
+//     "leaderboard": [ {"player": "dan", "score": 120, "time": 1700000000}, ... ],
+//     "history": [ {"time": 1700000000, "score": 120, "caught": 14,
+//                   "missed": 2, "duration_ms": 61000, "mode": "classic"}, ... ]
+//   }
+//
+// Unknown keys and nested values are skipped. A known field whose number
+// does not fit it (a history score, say, past 32 bits) fails the load.
+struct RecordSet {
+    std::vector<ScoreEntry> leaderboard;
+    std::vector<SessionRecord> history;
+};
+
+// Streams the file through json.hpp's SAX parser and fills the records
+// directly. No DOM is built, so peak memory follows the size of the output
+// rather than the size of the file. Returns false and sets error on failure;
+// out keeps whatever was read up to that point.
+bool loadRecords(const std::string& path, RecordSet& out, std::string& error);
+
+// Same as loadRecords, for an in-memory document.
+bool parseRecords(const std::string& text, RecordSet& out, std::string& error);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Compact persisted records. Kept trivially copyable so they can be stored
+// in flat arrays and written to disk as-is.
+
+enum class GameMode : std::uint8_t {
+    Classic,
+    TimeAttack,
+    Zen,
+    Challenge
+};
+
+const int PLAYER_NAME_SIZE = 16;
+
+struct ScoreEntry {
+    std::int64_t score;
+    std::int64_t timestamp;             // seconds since epoch
+    char player[PLAYER_NAME_SIZE];      // not necessarily null-terminated
+};
+
+struct SessionRecord {
+    std::int64_t timestamp;
+    std::int32_t score;
+    std::int32_t caught;
+    std::int32_t missed;
+    std::int32_t durationMs;
+    GameMode mode;
+};
+
+inline void setPlayerName(ScoreEntry& entry, const std::string& name) {
+    std::memset(entry.player, 0, PLAYER_NAME_SIZE);
+    std::memcpy(entry.player, name.data(),
+                name.size() < PLAYER_NAME_SIZE ? name.size() : PLAYER_NAME_SIZE);
+}
+
+inline std::string playerName(const ScoreEntry& entry) {
+    return std::string(entry.player, strnlen(entry.player, PLAYER_NAME_SIZE));
+}
+
+inline bool parseGameMode(const std::string& name, GameMode& mode) {
+    if (name == "classic") mode = GameMode::Classic;
+    else if (name == "time_attack") mode = GameMode::TimeAttack;
+    else if (name == "zen") mode = GameMode::Zen;
+    else if (name == "challenge") mode = GameMode::Challenge;
+    else return false;
+    return true;
+}
+
+inline const char* gameModeName(GameMode mode) {
+    switch (mode) {
+        case GameMode::TimeAttack: return "time_attack";
+        case GameMode::Zen: return "zen";
+        case GameMode::Challenge: return "challenge";
+        default: return "classic";
+    }
+}
@@ -0,0 +1,55 @@
+#include "renderer.h"
+
+#include <cmath>
+
+namespace {
+
+// Two cells wide and one cell tall in either sub-cell mode, rounded where
+// braille has the dots for it
+const char* const BRAILLE_BALL[4] = {".##.", "####", "####", ".##."};
+const char* const HALF_BLOCK_BALL[2] = {"##", "##"};
+
+void drawBall(Framebuffer& screen, GlyphMode mode, int dotX, int dotY, Style style) {
+    const char* const* rows = mode == GlyphMode::Braille ? BRAILLE_BALL : HALF_BLOCK_BALL;
+    for (int y = 0; y < dotRows(mode); y++) {
+        for (int x = 0; rows[y][x]; x++) {
+            if (rows[y][x] == '#') plotDot(screen, mode, dotX + x, dotY + y, style);
+        }
+    }
+}
+
+}  // namespace
+
+void drawPlayfield(Framebuffer& screen, int top, const Simulation& sim, GlyphMode mode, float alpha) {
+    const SimulationConfig& config = sim.getConfig();
+    const std::vector<Fruit>& fruits = sim.getFruits();
+    int ground = top + config.height - 1;
+
+    for (int x = 0; x < config.width; x++) screen.put(x, ground, '-', Style::Ground);
+    for (const auto& basket : sim.getBaskets()) {
+        int fruit = 0;
+        while (fruit < static_cast<int>(fruits.size()) && fruits[fruit].type != basket.type) fruit++;
+        screen.put(basket.x, ground, basket.symbol, fruitStyle(fruit));
+    }
+
+    FruitPlacement placement = fruitPlacement(top, sim, alpha);
+    if (!placement.visible || mode == GlyphMode::Sprites) return;
+    Style style = fruitStyle(placement.fruit);
+    char symbol = sim.fruit()->symbol;
+    if (mode == GlyphMode::Text) {
+        screen.put(placement.column, top + sim.fruitRow(), symbol, style);
+        return;
+    }
+
+    int rows = dotRows(mode);
+    drawBall(screen, mode, placement.column * dotColumns(mode),
+             static_cast<int>(std::lround(placement.row * rows)), style);
+    screen.put(placement.column + 2, static_cast<int>(std::lround(placement.row)), symbol, style);
+}
+
+FruitPlacement fruitPlacement(int top, const Simulation& sim, float alpha) {
+    const SimulationConfig& config = sim.getConfig();
+    if (!sim.fruit() || sim.fruitRow() >= config.height - 1) return FruitPlacement{false, 0, 0, -1};
+    float row = sim.previousFruitRow() + (sim.fruitRow() - sim.previousFruitRow()) * alpha;
+    return FruitPlacement{true, config.width / 2, top + row, sim.fruitIndex()};
+}
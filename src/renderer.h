@@ -0,0 +1,28 @@
+#pragma once
+
+#include "framebuffer.h"
+#include "simulation.h"
+#include "subcell.h"
+
+// Draws the playfield of sim into rows [top, top + height) of screen: the
+// falling fruit in the middle column and the baskets on the ground row,
+// each fruit type and its basket in that fruit's style.
+//
+// In the sub-cell glyph modes the falling fruit is a ball of dots with its
+// symbol beside it, drawn alpha of the way from its row before the last
+// tick to its current one, so frames drawn between ticks show it moving
+// smoothly. Text mode always draws the current row, and Sprites mode
+// leaves the falling fruit out for a SpriteLayer to place.
+void drawPlayfield(Framebuffer& screen, int top, const Simulation& sim,
+                   GlyphMode mode = GlyphMode::Text, float alpha = 1);
+
+// Where the falling fruit is drawn: its column, and its screen row with
+// the fraction of the way to the next.
+struct FruitPlacement {
+    bool visible;
+    int column;
+    float row;
+    int fruit;      // index into the simulation's fruits
+};
+
+FruitPlacement fruitPlacement(int top, const Simulation& sim, float alpha);
@@ -0,0 +1,18 @@
+#include "save_data.h"
+
+#include "json_arena.h"
+#include "util.h"
+
+bool saveReplay(const std::string& path, const Replay& replay, std::string& error) {
+    ArenaDocument doc;
+    JsonArenaScope scope(doc.arena());
+    ArenaJson& root = doc.root();
+
+    root["seed"] = replay.seed;
+    root["day"] = replay.day;
+    ArenaJson& events = root["events"] = ArenaJson::array();
+    for (const auto& event : replay.events) {
+        events.push_back(ArenaJson::array({simEventCode(event.event), event.fruit, event.score}));
+    }
+    return replaceFile(path, root.dump(), error);
+}
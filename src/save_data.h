@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "records.h"
+#include "simulation.h"
+
+// Lifetime player stats, saved as profile.json.
+struct Profile {
+    std::string player;
+    int gamesPlayed;
+    std::int64_t bestScore;
+    std::int64_t totalCaught;
+    std::int64_t totalMissed;
+    std::vector<std::string> achievements;
+    std::vector<SessionRecord> history;
+};
+
+struct ReplayEvent {
+    SimEvent event;
+    int fruit;
+    int score;
+};
+
+// Replay files store events as these codes
+inline int simEventCode(SimEvent event) {
+    switch (event) {
+        case SimEvent::Caught: return 1;
+        case SimEvent::WrongBasket: return 2;
+        case SimEvent::Dropped: return 3;
+        default: return 0;
+    }
+}
+
+inline SimEvent simEventFromCode(int code) {
+    switch (code) {
+        case 1: return SimEvent::Caught;
+        case 2: return SimEvent::WrongBasket;
+        case 3: return SimEvent::Dropped;
+        default: return SimEvent::None;
+    }
+}
+
+// Outcome-level record of one session; replaying the seed through a
+// Simulation reproduces the fruit sequence.
+struct Replay {
+    std::uint64_t seed;
+    int day;                // challenge day, -1 for a classic game
+    std::vector<ReplayEvent> events;
+};
+
+// Written through an arena-backed json document, so a save costs a handful
+// of block allocations instead of one per node and string. The game saves
+// its profile through ProfileStore; the whole-file profile loader and saver
+// and the replay loader are in save_files.h, outside the game.
+bool saveReplay(const std::string& path, const Replay& replay, std::string& error);
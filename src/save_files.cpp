@@ -0,0 +1,52 @@
+#include "save_files.h"
+
+#include <fstream>
+
+#include "json_arena.h"
+#include "profile_json.h"
+#include "util.h"
+
+bool loadProfile(const std::string& path, Profile& out, std::string& error) {
+    out = Profile{"player", 0, 0, 0, 0, {}, {}};
+    if (!std::ifstream(path)) return true;
+
+    ArenaDocument doc;
+    if (!doc.parseFile(path, error)) return false;
+
+    JsonArenaScope scope(doc.arena());
+    if (!profileFromJson(doc.root(), out, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool saveProfile(const std::string& path, const Profile& profile, std::string& error) {
+    ArenaDocument doc;
+    JsonArenaScope scope(doc.arena());
+    profileToJson(profile, doc.root());
+    return replaceFile(path, doc.root().dump(), error);
+}
+
+bool loadReplay(const std::string& path, Replay& out, std::string& error) {
+    ArenaDocument doc;
+    if (!doc.parseFile(path, error)) return false;
+
+    JsonArenaScope scope(doc.arena());
+    const ArenaJson& root = doc.root();
+    try {
+        out.seed = root.at("seed").get<std::uint64_t>();
+        out.day = root.value("day", -1);
+        out.events.clear();
+        out.events.reserve(root.at("events").size());
+        // Events are [event, fruit, score] triples to keep replays small
+        for (const auto& item : root.at("events")) {
+            out.events.push_back(ReplayEvent{simEventFromCode(item.at(0).get<int>()),
+                                             item.at(1).get<int>(), item.at(2).get<int>()});
+        }
+    } catch (const ArenaJson::exception& ex) {
+        error = path + ": " + ex.what();
+        return false;
+    }
+    return true;
+}
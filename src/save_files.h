@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+#include "save_data.h"
+
+// Whole-file profile and replay loaders for benches and tools; the game
+// itself keeps its profile in a ProfileStore and only writes replays. Both
+// go through an arena-backed json document, so a load or save costs a
+// handful of block allocations instead of one per node and string. A
+// missing profile loads as a fresh one.
+bool loadProfile(const std::string& path, Profile& out, std::string& error);
+bool saveProfile(const std::string& path, const Profile& profile, std::string& error);
+
+bool loadReplay(const std::string& path, Replay& out, std::string& error);
@@ -0,0 +1,115 @@
+#include "simulation.h"
+
+#include <algorithm>
+
+Simulation::Simulation(const std::vector<Fruit>& fruits, const SimulationConfig& config,
+                       std::uint64_t seed)
+    : config(config), fruits(fruits), currentIndex(-1), fruitY(0), previousFruitY(0),
+      score(0), spawned(0), weightTotal(0), rngState(seed) {
+    for (int weight : this->config.fruitWeights) weightTotal += weight;
+    initializeBaskets();
+}
+
+void Simulation::initializeBaskets() {
+    if (!config.baskets.empty()) {
+        baskets = config.baskets;
+    } else {
+        for (size_t i = 0; i < fruits.size(); i++) {
+            Basket basket;
+            basket.type = fruits[i].type;
+            basket.symbol = fruits[i].symbol;
+            baskets.push_back(basket);
+        }
+    }
+    layoutBaskets();
+}
+
+// Only positions depend on the width, so a resize rewrites them in place
+void Simulation::layoutBaskets() {
+    if (!config.baskets.empty()) {
+        for (size_t i = 0; i < baskets.size(); i++) {
+            baskets[i].x = std::min(config.baskets[i].x, config.width - 1);
+        }
+        return;
+    }
+    int spacing = config.width / fruits.size();
+    for (size_t i = 0; i < baskets.size(); i++) baskets[i].x = i * spacing + spacing / 2;
+}
+
+// splitmix64
+std::uint32_t Simulation::nextRandom() {
+    std::uint64_t z = (rngState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<std::uint32_t>((z ^ (z >> 31)) >> 32);
+}
+
+int Simulation::pickFruit() {
+    if (weightTotal <= 0 || config.fruitWeights.size() != fruits.size()) {
+        return nextRandom() % fruits.size();
+    }
+    int roll = nextRandom() % weightTotal;
+    for (size_t i = 0; i < fruits.size(); i++) {
+        roll -= config.fruitWeights[i];
+        if (roll < 0) return i;
+    }
+    return fruits.size() - 1;
+}
+
+void Simulation::restore(int score, int spawned) {
+    for (int i = this->spawned; i < spawned; i++) pickFruit();
+    this->score = score;
+    this->spawned = spawned;
+}
+
+void Simulation::resize(int width, int height) {
+    if (width == config.width && height == config.height) return;
+    config.width = width;
+    config.height = height;
+    layoutBaskets();
+    fruitY = std::min(fruitY, std::max(height - 2, 0));
+    previousFruitY = std::min(previousFruitY, fruitY);
+}
+
+void Simulation::spawnFruit() {
+    if (currentIndex < 0) {
+        currentIndex = pickFruit();
+        fruitY = 0;
+        previousFruitY = 0;
+        spawned++;
+    }
+}
+
+SimEvent Simulation::sortInto(int basketIndex) {
+    if (currentIndex < 0 || basketIndex < 0 || basketIndex >= static_cast<int>(baskets.size())) {
+        return SimEvent::None;
+    }
+    SimEvent event;
+    if (fruits[currentIndex].type == baskets[basketIndex].type) {
+        score += config.catchPoints;
+        event = SimEvent::Caught;
+    } else {
+        score -= config.missPenalty;
+        event = SimEvent::WrongBasket;
+    }
+    currentIndex = -1;
+    return event;
+}
+
+SimEvent Simulation::tick() {
+    if (currentIndex >= 0) {
+        previousFruitY = fruitY;
+        fruitY++;
+        if (fruitY >= config.height - 1) {
+            currentIndex = -1;
+            score -= config.missPenalty;
+            return SimEvent::Dropped;
+        }
+    }
+    return SimEvent::None;
+}
+
+int Simulation::tickMs() const {
+    int ms = config.startTickMs - config.tickMsStep * std::max(spawned - 1, 0);
+    return std::max(ms, config.endTickMs);
+}
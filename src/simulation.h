@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "game_types.h"
+
+// Playfield size and pacing. The tick interval follows a speed curve that
+// starts at startTickMs and drops by tickMsStep per spawned fruit down to
+// endTickMs.
+struct SimulationConfig {
+    int width;
+    int height;
+    int startTickMs;
+    int endTickMs;
+    int tickMsStep;
+    std::vector<int> fruitWeights;  // spawn weight per fruit type, empty for uniform
+    std::vector<Basket> baskets;    // fixed layout, empty to space them evenly
+    int catchPoints = 10;
+    int missPenalty = 5;
+};
+
+enum class SimEvent {
+    None,
+    Caught,         // sorted into the matching basket
+    WrongBasket,    // sorted into another basket
+    Dropped         // reached the ground
+};
+
+// Deterministic game rules shared by Game::run and anything that needs to
+// play the game offline. Randomness comes from the seed only.
+class Simulation {
+private:
+    SimulationConfig config;
+    std::vector<Fruit> fruits;
+    std::vector<Basket> baskets;
+    int currentIndex;           // falling fruit type, -1 when none
+    int fruitY;
+    int previousFruitY;         // fruitY before the last tick
+    int score;
+    int spawned;
+    int weightTotal;
+    std::uint64_t rngState;
+
+    void initializeBaskets();
+    void layoutBaskets();
+    std::uint32_t nextRandom();
+    int pickFruit();
+
+public:
+    Simulation(const std::vector<Fruit>& fruits, const SimulationConfig& config,
+               std::uint64_t seed);
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Fast-forwards a fresh simulation to a recovered score and spawn count.
+    // Spawns are the only consumer of randomness, so the fruit sequence
+    // continues exactly where the original session left off.
+    void restore(int score, int spawned);
+
+    // Changes the playfield size mid-game. Baskets keep their order and
+    // move to the new lane positions (a fixed layout is clamped to the new
+    // width); a falling fruit stays in its column above the ground.
+    void resize(int width, int height);
+
+    void spawnFruit();
+    SimEvent sortInto(int basketIndex);
+    SimEvent tick();
+
+    const Fruit* fruit() const { return currentIndex >= 0 ? &fruits[currentIndex] : nullptr; }
+    int fruitIndex() const { return currentIndex; }
+    int fruitRow() const { return fruitY; }
+    // Where the fruit was before the last tick (its row when it spawned
+    // since), for drawing it between ticks.
+    int previousFruitRow() const { return previousFruitY; }
+    int getScore() const { return score; }
+    int spawnedCount() const { return spawned; }
+    int tickMs() const;
+    const std::vector<Basket>& getBaskets() const { return baskets; }
+    const std::vector<Fruit>& getFruits() const { return fruits; }
+    const SimulationConfig& getConfig() const { return config; }
+};
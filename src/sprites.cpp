@@ -0,0 +1,201 @@
+#include "sprites.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "terminal.h"
+#include "util.h"
+
+namespace {
+
+const int SPRITE_PIXELS = 32;
+// Largest payload per command the protocol allows, in base64 characters
+const std::size_t CHUNK = 4096;
+// Every command asks for no reply (q=2), so nothing arrives on stdin
+const char* const APC = "\x1b_G";
+const char* const ST = "\x1b\\";
+
+struct Rgb {
+    std::uint8_t r, g, b;
+};
+
+// The xterm 256-colour palette
+Rgb paletteRgb(int index) {
+    static const Rgb system[16] = {
+        {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0},
+        {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+        {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0},
+        {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}};
+    if (index < 0 || index > 255) return {255, 255, 255};
+    if (index < 16) return system[index];
+    if (index < 232) {
+        auto level = [](int v) { return static_cast<std::uint8_t>(v ? 55 + 40 * v : 0); };
+        int cube = index - 16;
+        return {level(cube / 36), level(cube / 6 % 6), level(cube % 6)};
+    }
+    std::uint8_t grey = static_cast<std::uint8_t>(8 + 10 * (index - 232));
+    return {grey, grey, grey};
+}
+
+// A shaded round fruit with a stem and a leaf, as RGBA rows
+void drawSprite(std::vector<std::uint8_t>& rgba, Rgb colour) {
+    rgba.assign(SPRITE_PIXELS * SPRITE_PIXELS * 4, 0);
+    auto set = [&](int x, int y, Rgb c) {
+        std::uint8_t* p = &rgba[(y * SPRITE_PIXELS + x) * 4];
+        p[0] = c.r;
+        p[1] = c.g;
+        p[2] = c.b;
+        p[3] = 255;
+    };
+    for (int y = 0; y < SPRITE_PIXELS; y++) {
+        for (int x = 0; x < SPRITE_PIXELS; x++) {
+            int dx = x - 16;
+            int dy = y - 18;
+            if (dx * dx + dy * dy <= 13 * 13) {
+                // Lit from the top left
+                int hx = x - 11;
+                int hy = y - 13;
+                float shade = 1.15f - (hx * hx + hy * hy) / 900.0f;
+                auto scale = [shade](std::uint8_t v) {
+                    float scaled = v * shade;
+                    return static_cast<std::uint8_t>(scaled > 255 ? 255 : scaled < 0 ? 0 : scaled);
+                };
+                set(x, y, {scale(colour.r), scale(colour.g), scale(colour.b)});
+            }
+            int lx = x - 21;
+            int ly = y - 4;
+            if (lx * lx + 4 * ly * ly <= 16) set(x, y, {40, 170, 40});
+        }
+    }
+    for (int y = 1; y < 7; y++) {
+        set(15, y, {110, 70, 30});
+        set(16, y, {110, 70, 30});
+    }
+}
+
+void appendBase64(std::string& out, const std::uint8_t* data, std::size_t size) {
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        std::uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += digits[v >> 18];
+        out += digits[(v >> 12) & 63];
+        out += digits[(v >> 6) & 63];
+        out += digits[v & 63];
+    }
+    if (i < size) {
+        std::uint32_t v = data[i] << 16;
+        if (i + 1 < size) v |= data[i + 1] << 8;
+        out += digits[v >> 18];
+        out += digits[(v >> 12) & 63];
+        out += i + 1 < size ? digits[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+}
+
+void appendKey(std::string& out, const char* key, int value) {
+    out += key;
+    appendNumber(out, value);
+}
+
+}  // namespace
+
+SpriteLayer::SpriteLayer(int firstImageId)
+    : firstImageId(firstImageId), imageCount(0), cellHeightPx(0), resetPending(false),
+      placedImage(0), placedColumn(0), placedRow(0), placedOffsetPx(0) {}
+
+std::size_t SpriteLayer::upload(std::string& out, const Theme& theme, int fruitCount) {
+    std::size_t start = out.size();
+    std::vector<std::uint8_t> rgba;
+    std::string payload;
+    for (int fruit = 0; fruit < fruitCount; fruit++) {
+        int fg = theme.spec(fruitStyle(fruit)).fg;
+        drawSprite(rgba, paletteRgb(fg >= 0 ? fg : 231));
+        payload.clear();
+        appendBase64(payload, rgba.data(), rgba.size());
+
+        for (std::size_t offset = 0; offset < payload.size(); offset += CHUNK) {
+            bool last = offset + CHUNK >= payload.size();
+            out += APC;
+            if (offset == 0) {
+                out += "a=t,f=32,q=2";
+                appendKey(out, ",s=", SPRITE_PIXELS);
+                appendKey(out, ",v=", SPRITE_PIXELS);
+                appendKey(out, ",i=", firstImageId + fruit);
+                out += ',';
+            }
+            out += last ? "m=0;" : "m=1;";
+            out.append(payload, offset, CHUNK);
+            out += ST;
+        }
+    }
+    imageCount = fruitCount;
+    return out.size() - start;
+}
+
+std::size_t SpriteLayer::update(std::string& out, const FruitPlacement& placement) {
+    std::size_t start = out.size();
+    if (resetPending) {
+        // Lowercase d: the placements go, the uploaded images stay
+        out += APC;
+        out += "a=d,d=a,q=2;";
+        out += ST;
+        placedImage = 0;
+        resetPending = false;
+    }
+
+    int image = placement.visible && placement.fruit < imageCount ? firstImageId + placement.fruit : 0;
+    int row = static_cast<int>(placement.row);
+    int offset = cellHeightPx > 0 ? static_cast<int>((placement.row - row) * cellHeightPx) : 0;
+    if (image == placedImage &&
+        (image == 0 || (placement.column == placedColumn && row == placedRow && offset == placedOffsetPx))) {
+        return 0;
+    }
+
+    if (placedImage != 0 && placedImage != image) {
+        out += APC;
+        appendKey(out, "a=d,d=i,q=2,p=1,i=", placedImage);
+        out += ';';
+        out += ST;
+    }
+    if (image != 0) {
+        // Placing an existing (image, placement) pair again moves it; C=1
+        // leaves the cursor where it was
+        out += "\x1b[";
+        appendNumber(out, row + 1);
+        out += ';';
+        appendNumber(out, placement.column + 1);
+        out += 'H';
+        out += APC;
+        appendKey(out, "a=p,p=1,c=2,r=1,C=1,q=2,i=", image);
+        if (offset > 0) appendKey(out, ",Y=", offset);
+        out += ';';
+        out += ST;
+    }
+    placedImage = image;
+    placedColumn = placement.column;
+    placedRow = row;
+    placedOffsetPx = offset;
+    return out.size() - start;
+}
+
+std::size_t SpriteLayer::release(std::string& out) {
+    std::size_t start = out.size();
+    for (int i = 0; i < imageCount; i++) {
+        // Uppercase I: placements and image data
+        out += APC;
+        appendKey(out, "a=d,d=I,q=2,i=", firstImageId + i);
+        out += ';';
+        out += ST;
+    }
+    imageCount = 0;
+    placedImage = 0;
+    return out.size() - start;
+}
+
+bool probeKittyGraphics(int inFd, int outFd, int timeoutMs) {
+    // A one-pixel query image
+    std::string reply;
+    return queryTerminal(inFd, outFd, "\x1b_Gi=31,s=1,v=1,a=q,t=d,f=24;AAAA\x1b\\", reply, timeoutMs) &&
+           reply.find("\x1b_Gi=31;OK") != std::string::npos;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "renderer.h"
+#include "theme.h"
+
+// Fruit sprites through the kitty graphics protocol. Each fruit's image is
+// uploaded once under its own image ID; after that a frame only carries
+// placement commands, and only when the sprite moved. All commands go into
+// the caller's frame buffer, so the byte stream can be captured and checked
+// without a terminal.
+class SpriteLayer {
+private:
+    int firstImageId;
+    int imageCount;
+    int cellHeightPx;           // 0 when unknown: no sub-cell offsets
+    bool resetPending;          // the screen was cleared under the placement
+    // Current placement, image 0 when none
+    int placedImage;
+    int placedColumn;
+    int placedRow;
+    int placedOffsetPx;
+
+public:
+    explicit SpriteLayer(int firstImageId = 7000);
+
+    // Appends the upload of one sprite per fruit, coloured with the fruit
+    // styles of theme. Returns the number of bytes appended.
+    std::size_t upload(std::string& out, const Theme& theme, int fruitCount);
+    bool isUploaded() const { return imageCount > 0; }
+
+    // Lets placements move by pixels within a cell; without it they move
+    // by whole rows.
+    void setCellHeight(int pixels) { cellHeightPx = pixels; }
+
+    // The screen was cleared; the next update removes whatever placement
+    // the terminal still shows and places the sprite again.
+    void invalidate() { resetPending = true; }
+
+    // Appends the commands that move the sprite to placement, or remove it
+    // when the fruit is not visible: nothing when it is already there.
+    // Returns the number of bytes appended.
+    std::size_t update(std::string& out, const FruitPlacement& placement);
+
+    // Appends commands deleting every placement and image, freeing their
+    // memory in the terminal.
+    std::size_t release(std::string& out);
+};
+
+// Asks the terminal on outFd whether it supports the graphics protocol,
+// reading the reply from inFd for up to timeoutMs. The query is followed
+// by a primary device attributes request that every terminal answers, so
+// a terminal without graphics is recognised without waiting for the
+// timeout. inFd is put in raw mode while reading if it is a terminal.
+bool probeKittyGraphics(int inFd, int outFd, int timeoutMs);
@@ -0,0 +1,101 @@
+#include "subcell.h"
+
+#include <array>
+
+namespace {
+
+const char32_t BRAILLE_BASE = 0x2800;
+const char32_t UPPER_HALF = 0x2580;
+const char32_t LOWER_HALF = 0x2584;
+const char32_t FULL_BLOCK = 0x2588;
+
+// Braille numbers its dots down the left column, down the right one, then
+// the bottom row: bit of each dot in row-major order
+const unsigned BRAILLE_BIT[8] = {0, 3, 1, 4, 2, 5, 6, 7};
+
+struct BrailleTables {
+    std::array<std::uint8_t, 256> toBraille;    // row-major mask -> braille bits
+    std::array<std::uint8_t, 256> toMask;       // braille bits -> row-major mask
+};
+
+BrailleTables buildBrailleTables() {
+    BrailleTables tables{};
+    for (unsigned mask = 0; mask < 256; mask++) {
+        unsigned bits = 0;
+        for (unsigned dot = 0; dot < 8; dot++) {
+            if (mask & (1u << dot)) bits |= 1u << BRAILLE_BIT[dot];
+        }
+        tables.toBraille[mask] = static_cast<std::uint8_t>(bits);
+        tables.toMask[bits] = static_cast<std::uint8_t>(mask);
+    }
+    return tables;
+}
+
+const BrailleTables braille = buildBrailleTables();
+
+}  // namespace
+
+bool glyphModeByName(const std::string& name, GlyphMode& out) {
+    if (name == "text") {
+        out = GlyphMode::Text;
+    } else if (name == "halfblock") {
+        out = GlyphMode::HalfBlock;
+    } else if (name == "braille") {
+        out = GlyphMode::Braille;
+    } else if (name == "sprites") {
+        out = GlyphMode::Sprites;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int dotColumns(GlyphMode mode) {
+    return mode == GlyphMode::Braille ? 2 : 1;
+}
+
+int dotRows(GlyphMode mode) {
+    switch (mode) {
+    case GlyphMode::Braille: return 4;
+    case GlyphMode::HalfBlock: return 2;
+    default: return 1;
+    }
+}
+
+char32_t subcellGlyph(GlyphMode mode, unsigned mask) {
+    switch (mode) {
+    case GlyphMode::Braille:
+        return BRAILLE_BASE + braille.toBraille[mask & 0xff];
+    case GlyphMode::HalfBlock: {
+        static const char32_t halves[4] = {' ', UPPER_HALF, LOWER_HALF, FULL_BLOCK};
+        return halves[mask & 3];
+    }
+    default:
+        return (mask & 1) ? FULL_BLOCK : ' ';
+    }
+}
+
+unsigned subcellMask(GlyphMode mode, char32_t glyph) {
+    switch (mode) {
+    case GlyphMode::Braille:
+        return glyph >= BRAILLE_BASE && glyph < BRAILLE_BASE + 256 ? braille.toMask[glyph - BRAILLE_BASE] : 0;
+    case GlyphMode::HalfBlock:
+        if (glyph == UPPER_HALF) return 1;
+        if (glyph == LOWER_HALF) return 2;
+        return glyph == FULL_BLOCK ? 3 : 0;
+    default:
+        return glyph == FULL_BLOCK ? 1 : 0;
+    }
+}
+
+void plotDot(Framebuffer& screen, GlyphMode mode, int dotX, int dotY, Style style) {
+    if (dotX < 0 || dotY < 0) return;
+    int columns = dotColumns(mode);
+    int rows = dotRows(mode);
+    int x = dotX / columns;
+    int y = dotY / rows;
+    if (x >= screen.getWidth() || y >= screen.getHeight()) return;
+    unsigned mask = subcellMask(mode, cellGlyph(screen.at(x, y)));
+    mask |= 1u << ((dotY % rows) * columns + dotX % columns);
+    screen.put(x, y, subcellGlyph(mode, mask), style);
+}
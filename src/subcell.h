@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "framebuffer.h"
+
+// How the playfield is drawn: whole text cells, dots at a finer resolution
+// using half-block (1x2 dots per cell) or braille (2x4) glyphs, or text
+// cells with the falling fruit left to a SpriteLayer.
+enum class GlyphMode : std::uint8_t {
+    Text,
+    HalfBlock,
+    Braille,
+    Sprites
+};
+
+// text, halfblock, braille or sprites; returns false for anything else.
+bool glyphModeByName(const std::string& name, GlyphMode& out);
+
+// Dots per cell across and down; 1x1 for Text and Sprites.
+int dotColumns(GlyphMode mode);
+int dotRows(GlyphMode mode);
+
+// Sets the dot at (dotX, dotY), counted in dots from the top left of
+// screen. A cell already holding a glyph of the same mode keeps its other
+// dots, taking the new style; any other content is replaced. In Text and
+// Sprites mode the cell becomes a full block.
+void plotDot(Framebuffer& screen, GlyphMode mode, int dotX, int dotY, Style style);
+
+// The glyph for a cell whose dots are mask, bit (row * dotColumns + column)
+// for each dot, and the inverse for glyphs of that mode (0 for any other
+// glyph).
+char32_t subcellGlyph(GlyphMode mode, unsigned mask);
+unsigned subcellMask(GlyphMode mode, char32_t glyph);
@@ -0,0 +1,107 @@
+#include "telemetry.h"
+
+#include <chrono>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "profiler.h"
+#include "util.h"
+
+namespace {
+
+const std::size_t FLUSH_BYTES = 64 * 1024;
+
+// Every field is an integer under a fixed key, so the line is formatted
+// directly: json.hpp only dumps into a string or stream it allocates for.
+void appendSample(std::string& out, const FrameSample& sample) {
+    out += "{\"frame\":";
+    appendNumber(out, static_cast<long long>(sample.frame));
+    out += ",\"t_ns\":";
+    appendNumber(out, sample.timeNs);
+    out += ",\"frame_ns\":";
+    appendNumber(out, sample.frameNs);
+    out += ",\"render_bytes\":";
+    appendNumber(out, sample.renderBytes);
+    out += ",\"input_ns\":";
+    appendNumber(out, sample.inputLatencyNs);
+    out += ",\"score\":";
+    appendNumber(out, sample.score);
+    out += ",\"fruits\":";
+    appendNumber(out, sample.activeFruits);
+    out += ",\"dropped\":";
+    appendNumber(out, sample.dropped);
+    out += "}\n";
+}
+
+}  // namespace
+
+Telemetry::Telemetry(std::size_t capacity, int flushIntervalMs)
+    : ring(roundUpPow2(capacity)), mask(ring.size() - 1), flushIntervalMs(flushIntervalMs),
+      fd(-1), head(0), tailCache(0), droppedCount(0), tail(0), writtenCount(0),
+      stopping(false) {}
+
+Telemetry::~Telemetry() {
+    close();
+}
+
+bool Telemetry::open(const std::string& path, std::string& error) {
+    close();
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    stopping = false;
+    writer = std::thread(&Telemetry::writerLoop, this);
+    return true;
+}
+
+void Telemetry::close() {
+    if (writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void Telemetry::writerLoop() {
+    std::string buffer;
+    buffer.reserve(FLUSH_BYTES + 1024);
+
+    bool failed = false;
+    auto flush = [&] {
+        if (!failed && !buffer.empty() && !writeAll(fd, buffer.data(), buffer.size())) {
+            std::cerr << "telemetry: write failed\n";
+            failed = true;
+        }
+        buffer.clear();
+    };
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (bool last = false; !last;) {
+        wake.wait_for(lock, std::chrono::milliseconds(flushIntervalMs));
+        last = stopping;
+        lock.unlock();
+
+        PROFILE_ZONE("telemetry_drain");
+        std::uint64_t from = tail.load(std::memory_order_relaxed);
+        std::uint64_t to = head.load(std::memory_order_acquire);
+        for (std::uint64_t pos = from; pos != to; pos++) {
+            appendSample(buffer, ring[pos & mask]);
+            // Release slots as we go so a long drain frees room early
+            tail.store(pos + 1, std::memory_order_release);
+            if (buffer.size() >= FLUSH_BYTES) flush();
+        }
+        flush();
+        writtenCount.fetch_add(to - from, std::memory_order_release);
+        lock.lock();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One sample per frame of the game loop, written as one NDJSON line:
+//
+//   {"frame":12,"t_ns":...,"frame_ns":...,"render_bytes":...,"input_ns":0,
+//    "score":40,"fruits":1,"dropped":0}
+struct FrameSample {
+    std::uint64_t frame;            // frame number
+    std::int64_t timeNs;            // steady clock at the start of the frame
+    std::uint32_t frameNs;          // input + updates + draw, without the sleep
+    std::uint32_t renderBytes;      // bytes written for the frame
+    std::uint32_t inputLatencyNs;   // key read to the frame showing it, 0 if no input
+    std::int32_t score;
+    std::uint16_t activeFruits;
+    std::uint16_t dropped;          // 1 if the frame was not sent, output backed up
+};
+
+// Streams per-frame metrics as newline-delimited JSON for offline analysis.
+// record() copies the sample into a single-producer ring and never blocks:
+// when the writer falls a whole ring behind the sample is dropped and counted.
+// A background thread drains the ring every flushIntervalMs into one output
+// buffer reused for the whole session, so steady-state writing does not
+// allocate.
+class Telemetry {
+private:
+    std::vector<FrameSample> ring;
+    std::uint64_t mask;
+    int flushIntervalMs;
+    int fd;
+
+    // Producer side
+    alignas(64) std::atomic<std::uint64_t> head;
+    std::uint64_t tailCache;
+    std::atomic<std::uint64_t> droppedCount;
+
+    // Consumer side
+    alignas(64) std::atomic<std::uint64_t> tail;
+    std::atomic<std::uint64_t> writtenCount;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread writer;
+
+    void writerLoop();
+
+public:
+    // capacity is rounded up to a power of two.
+    explicit Telemetry(std::size_t capacity = 8192, int flushIntervalMs = 100);
+    ~Telemetry();
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Starts a fresh stream at path, replacing any previous one.
+    bool open(const std::string& path, std::string& error);
+
+    // Writes everything recorded so far and stops the writer.
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Does nothing unless the sink is open.
+    void record(const FrameSample& sample) {
+        if (fd < 0) return;
+        std::uint64_t pos = head.load(std::memory_order_relaxed);
+        if (pos - tailCache >= ring.size()) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (pos - tailCache >= ring.size()) {
+                droppedCount.store(droppedCount.load(std::memory_order_relaxed) + 1,
+                                   std::memory_order_relaxed);
+                return;
+            }
+        }
+        ring[pos & mask] = sample;
+        head.store(pos + 1, std::memory_order_release);
+    }
+
+    std::uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+    std::uint64_t written() const { return writtenCount.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,323 @@
+#include "terminal.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+#else
+#include <conio.h>
+#endif
+
+namespace {
+
+// Starts set so the first frame adopts the terminal's size
+volatile std::sig_atomic_t resized = 1;
+
+// Alternate screen, cursor hidden and at home
+const char ENTER[] = "\x1b[?1049h\x1b[?25l\x1b[H";
+// Ends an update a signal may have interrupted (terminals ignore the mode
+// when they do not know it), then resets the style, shows the cursor and
+// returns to the normal screen
+const char LEAVE[] = "\x1b[?2026l\x1b[0m\x1b[?25h\x1b[?1049l";
+const char BEGIN_UPDATE[] = "\x1b[?2026h";
+const char END_UPDATE[] = "\x1b[?2026l";
+
+volatile std::sig_atomic_t sessionActive = 0;
+bool synchronized = false;
+
+#ifndef _WIN32
+
+// How long entering or leaving waits for a stalled terminal to take more
+const int SESSION_WRITE_TIMEOUT_MS = 500;
+
+termios savedInput{};
+termios rawInput{};
+bool inputIsTerminal = false;
+// The session's own non-blocking descriptor for the terminal, or -1 to
+// write to stdout
+int sessionOut = -1;
+
+// Everything below here runs in signal handlers too, so it only uses
+// async-signal-safe calls
+
+void writeTerminal(const char* data, std::size_t size) {
+    int fd = sessionOut >= 0 ? sessionOut : STDOUT_FILENO;
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count < 0) {
+            if (errno == EAGAIN) {
+                pollfd out{fd, POLLOUT, 0};
+                if (poll(&out, 1, SESSION_WRITE_TIMEOUT_MS) == 0) return;
+            } else if (errno != EINTR) {
+                return;
+            }
+            continue;
+        }
+        data += count;
+        size -= static_cast<std::size_t>(count);
+    }
+}
+
+void restoreTerminal() {
+    writeTerminal(LEAVE, sizeof(LEAVE) - 1);
+    if (inputIsTerminal) tcsetattr(STDIN_FILENO, TCSANOW, &savedInput);
+}
+
+void applyTerminal() {
+    if (inputIsTerminal) tcsetattr(STDIN_FILENO, TCSANOW, &rawInput);
+    writeTerminal(ENTER, sizeof(ENTER) - 1);
+}
+
+const int FATAL_SIGNALS[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT, SIGABRT, SIGSEGV, SIGBUS, SIGFPE};
+
+// Restores, then lets the signal take its default action: the handler
+// was reset on entry and the raised signal is delivered once it returns
+void onFatalSignal(int signal) {
+    int saved = errno;
+    if (sessionActive) {
+        sessionActive = 0;
+        restoreTerminal();
+    }
+    raise(signal);
+    errno = saved;
+}
+
+void onSuspend(int) {
+    int saved = errno;
+    if (sessionActive) restoreTerminal();
+    raise(SIGTSTP);
+    errno = saved;
+}
+
+void catchSignal(int signal, void (*handler)(int), int flags) {
+    struct sigaction action{};
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = flags;
+    sigaction(signal, &action, nullptr);
+}
+
+void onResume(int) {
+    int saved = errno;
+    if (sessionActive) {
+        applyTerminal();
+        // The screen was left while stopped: redraw all of it
+        resized = 1;
+    }
+    catchSignal(SIGTSTP, onSuspend, SA_RESTART | SA_RESETHAND);
+    errno = saved;
+}
+
+#endif
+
+}  // namespace
+
+#ifndef _WIN32
+
+bool terminalSize(int& columns, int& rows) {
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 || size.ws_row == 0) {
+        return false;
+    }
+    columns = size.ws_col;
+    rows = size.ws_row;
+    return true;
+}
+
+bool cellPixelSize(int& width, int& height) {
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 || size.ws_row == 0 ||
+        size.ws_xpixel == 0 || size.ws_ypixel == 0) {
+        return false;
+    }
+    width = size.ws_xpixel / size.ws_col;
+    height = size.ws_ypixel / size.ws_row;
+    return true;
+}
+
+void watchResize() {
+    catchSignal(SIGWINCH, [](int) { resized = 1; }, SA_RESTART);
+}
+
+int reopenNonBlocking(int fd) {
+    struct stat info{};
+    if (fstat(fd, &info) != 0) return -1;
+    std::string path;
+    if (isatty(fd)) {
+        const char* name = ttyname(fd);
+        if (!name) return -1;
+        path = name;
+    } else if (S_ISFIFO(info.st_mode)) {
+        path = "/proc/self/fd/" + std::to_string(fd);
+    } else {
+        return -1;
+    }
+    return open(path.c_str(), O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+}
+
+bool queryTerminal(int inFd, int outFd, const char* query, std::string& reply, int timeoutMs) {
+    termios saved{};
+    bool raw = isatty(inFd) && tcgetattr(inFd, &saved) == 0;
+    if (raw) {
+        termios settings = saved;
+        settings.c_lflag &= ~(ICANON | ECHO);
+        settings.c_cc[VMIN] = 0;
+        settings.c_cc[VTIME] = 0;
+        tcsetattr(inFd, TCSANOW, &settings);
+    }
+
+    std::string request = query;
+    request += "\x1b[c";
+    bool written = write(outFd, request.data(), request.size()) == static_cast<ssize_t>(request.size());
+    if (written) {
+        pollfd in{inFd, POLLIN, 0};
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0 || poll(&in, 1, static_cast<int>(left.count())) <= 0) break;
+            char buffer[256];
+            ssize_t count = read(inFd, buffer, sizeof(buffer));
+            if (count <= 0) break;
+            reply.append(buffer, count);
+            // The attributes reply, ESC [ ? ... c, comes last
+            std::size_t attributes = reply.rfind("\x1b[?");
+            if (attributes != std::string::npos && reply.find('c', attributes) != std::string::npos) break;
+        }
+    }
+
+    if (raw) tcsetattr(inFd, TCSANOW, &saved);
+    return written;
+}
+
+bool probeSynchronizedOutput(int inFd, int outFd, int timeoutMs) {
+    // Report mode (DECRQM); the answer is ESC [ ? 2026 ; value $ y where
+    // 1 and 3 mean set, 2 reset, and 0 and 4 unknown or not resettable
+    std::string reply;
+    if (!queryTerminal(inFd, outFd, "\x1b[?2026$p", reply, timeoutMs)) return false;
+    const char prefix[] = "\x1b[?2026;";
+    std::size_t at = reply.find(prefix);
+    std::size_t valueAt = at + sizeof(prefix) - 1;
+    if (at == std::string::npos || valueAt >= reply.size()) return false;
+    char value = reply[valueAt];
+    return value == '1' || value == '2' || value == '3';
+}
+
+bool enterSession(int probeTimeoutMs) {
+    if (sessionActive || !isatty(STDOUT_FILENO)) return false;
+    inputIsTerminal = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &savedInput) == 0;
+    if (inputIsTerminal) {
+        // Keys without Enter and without echo; signals from ^C and ^Z
+        // still arrive
+        rawInput = savedInput;
+        rawInput.c_lflag &= ~(ICANON | ECHO);
+        rawInput.c_cc[VMIN] = 0;
+        rawInput.c_cc[VTIME] = 0;
+    }
+    synchronized = inputIsTerminal && probeSynchronizedOutput(STDIN_FILENO, STDOUT_FILENO, probeTimeoutMs);
+    sessionOut = reopenNonBlocking(STDOUT_FILENO);
+
+    std::cout.flush();
+    for (int signal : FATAL_SIGNALS) catchSignal(signal, onFatalSignal, SA_RESETHAND);
+    catchSignal(SIGTSTP, onSuspend, SA_RESTART | SA_RESETHAND);
+    catchSignal(SIGCONT, onResume, SA_RESTART);
+    static bool registered = false;
+    if (!registered) {
+        std::atexit(leaveSession);
+        registered = true;
+    }
+    sessionActive = 1;
+    applyTerminal();
+    return true;
+}
+
+void leaveSession() {
+    if (!sessionActive) return;
+    std::cout.flush();
+    sessionActive = 0;
+    restoreTerminal();
+    for (int signal : FATAL_SIGNALS) catchSignal(signal, SIG_DFL, 0);
+    catchSignal(SIGTSTP, SIG_DFL, 0);
+    catchSignal(SIGCONT, SIG_DFL, 0);
+    if (sessionOut >= 0) close(sessionOut);
+    sessionOut = -1;
+}
+
+bool keyPressed() {
+    pollfd in{STDIN_FILENO, POLLIN, 0};
+    return poll(&in, 1, 0) > 0;
+}
+
+int readKey() {
+    unsigned char key;
+    return read(STDIN_FILENO, &key, 1) == 1 ? key : -1;
+}
+
+#else
+
+bool terminalSize(int&, int&) {
+    return false;
+}
+
+bool cellPixelSize(int&, int&) {
+    return false;
+}
+
+void watchResize() {}
+
+bool queryTerminal(int, int, const char*, std::string&, int) {
+    return false;
+}
+
+bool probeSynchronizedOutput(int, int, int) {
+    return false;
+}
+
+int reopenNonBlocking(int) {
+    return -1;
+}
+
+bool enterSession(int) {
+    return false;
+}
+
+void leaveSession() {}
+
+bool keyPressed() {
+    return _kbhit() != 0;
+}
+
+int readKey() {
+    return _getch();
+}
+
+#endif
+
+bool takeResize() {
+    if (!resized) return false;
+    // Cleared before the size is read, so a resize during the read is
+    // seen on the next call
+    resized = 0;
+    return true;
+}
+
+bool synchronizedOutput() {
+    return sessionActive && synchronized;
+}
+
+void beginSynchronizedUpdate(std::string& out) {
+    if (synchronizedOutput()) out.append(BEGIN_UPDATE, sizeof(BEGIN_UPDATE) - 1);
+}
+
+void endSynchronizedUpdate(std::string& out) {
+    if (synchronizedOutput()) out.append(END_UPDATE, sizeof(END_UPDATE) - 1);
+}
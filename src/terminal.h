@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+
+// The terminal the game draws on (stdout).
+
+// Size in cells; returns false when stdout is not a terminal or the size
+// is unknown.
+bool terminalSize(int& columns, int& rows);
+
+// Size of one cell in pixels; returns false when the terminal does not
+// report its pixel size.
+bool cellPixelSize(int& width, int& height);
+
+// Installs a SIGWINCH handler that only marks the terminal as resized, so
+// the game loop picks the new size up between frames.
+void watchResize();
+
+// True once per resize since the previous call, and on the first call.
+bool takeResize();
+
+// Writes query to outFd followed by a primary device attributes request,
+// which every terminal answers, and collects what comes back on inFd into
+// reply until that answer arrives or timeoutMs passes. inFd is put in raw
+// mode while reading if it is a terminal. Returns false if the query could
+// not be written.
+bool queryTerminal(int inFd, int outFd, const char* query, std::string& reply, int timeoutMs);
+
+// Asks the terminal whether it supports synchronized output (DEC private
+// mode 2026), which holds back drawing between the begin and end markers
+// so a frame appears all at once.
+bool probeSynchronizedOutput(int inFd, int outFd, int timeoutMs);
+
+// Opens the terminal or pipe fd writes to again, as a new non-blocking
+// open file description. Setting O_NONBLOCK on fd itself would also set it
+// on every descriptor sharing its description, usually stdin and stderr,
+// where a write that cannot go through at once fails instead. Returns -1
+// for anything else, such as a socket or a file, or if it cannot be opened.
+int reopenNonBlocking(int fd);
+
+// A full-screen session on stdin and stdout: the alternate screen with the
+// cursor hidden and stdin in raw mode, so keys arrive without Enter and
+// are not echoed. Returns false, changing nothing, when stdout is not a
+// terminal. The terminal is restored by leaveSession, at exit, and on the
+// signals that end or suspend the process, giving up if it takes no output
+// for a while rather than hanging; a suspended session is entered again on
+// SIGCONT and reported as a resize so the next frame redraws.
+bool enterSession(int probeTimeoutMs);
+
+// Restores the terminal as it was before enterSession. Does nothing
+// outside a session.
+void leaveSession();
+
+// Whether the session's terminal confirmed synchronized output.
+bool synchronizedOutput();
+
+// Append the begin and end markers of a synchronized update, or nothing
+// when the terminal does not support them.
+void beginSynchronizedUpdate(std::string& out);
+void endSynchronizedUpdate(std::string& out);
+
+// Whether a key is waiting on stdin, and the next key, or -1 if there is
+// none.
+bool keyPressed();
+int readKey();
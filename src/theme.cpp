@@ -0,0 +1,80 @@
+#include "theme.h"
+
+namespace {
+
+std::string sgr(const StyleSpec& spec) {
+    std::string sequence = "\x1b[0";
+    if (spec.bold) sequence += ";1";
+    if (spec.fg >= 0) sequence += ";38;5;" + std::to_string(spec.fg);
+    if (spec.bg >= 0) sequence += ";48;5;" + std::to_string(spec.bg);
+    return sequence + "m";
+}
+
+}  // namespace
+
+Theme::Theme(const std::string& name, const std::vector<StyleSpec>& specs)
+    : themeName(name), specs(STYLE_COUNT, StyleSpec{-1, -1, false}), sequences(STYLE_COUNT),
+      paintsBlank(STYLE_COUNT, false) {
+    bool monochrome = specs.empty();
+    for (int style = 0; style < STYLE_COUNT; style++) {
+        StyleSpec spec = style < static_cast<int>(specs.size()) ? specs[style] : StyleSpec{-1, -1, false};
+        this->specs[style] = spec;
+        if (!monochrome) sequences[style] = sgr(spec);
+        paintsBlank[style] = !monochrome && spec.bg >= 0;
+    }
+}
+
+Theme Theme::monochrome() {
+    return Theme("mono", {});
+}
+
+Theme Theme::dark() {
+    return Theme("dark", {
+        {-1, -1, false},    // Default
+        {231, -1, true},    // Status
+        {244, -1, false},   // Hud
+        {220, -1, true},    // Achievement
+        {94, -1, false},    // Ground
+        {244, -1, false},   // Controls
+        {196, -1, true},    // fruit palette
+        {226, -1, true},
+        {161, -1, true},
+        {135, -1, true},
+        {46, -1, true},
+        {208, -1, true},
+        {51, -1, true},
+        {213, -1, true},
+    });
+}
+
+Theme Theme::light() {
+    return Theme("light", {
+        {-1, -1, false},
+        {16, -1, true},
+        {240, -1, false},
+        {130, -1, true},
+        {58, -1, false},
+        {240, -1, false},
+        {160, -1, true},
+        {136, -1, true},
+        {125, -1, true},
+        {55, -1, true},
+        {28, -1, true},
+        {166, -1, true},
+        {31, -1, true},
+        {162, -1, true},
+    });
+}
+
+bool Theme::byName(const std::string& name, Theme& out) {
+    if (name == "mono") {
+        out = monochrome();
+    } else if (name == "dark") {
+        out = dark();
+    } else if (name == "light") {
+        out = light();
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The roles the game draws with. Fruits and their baskets cycle through
+// FRUIT_STYLES palette entries starting at FruitBase. Framebuffer cells
+// store the underlying byte.
+enum class Style : std::uint8_t {
+    Default = 0,
+    Status,
+    Hud,
+    Achievement,
+    Ground,
+    Controls,
+    FruitBase
+};
+
+const int FRUIT_STYLES = 8;
+const int STYLE_COUNT = static_cast<int>(Style::FruitBase) + FRUIT_STYLES;
+
+inline Style fruitStyle(int fruit) {
+    return static_cast<Style>(static_cast<int>(Style::FruitBase) + (fruit < 0 ? 0 : fruit % FRUIT_STYLES));
+}
+
+// Colours of one style, as 256-colour palette indexes (-1 for the terminal
+// default).
+struct StyleSpec {
+    int fg;
+    int bg;
+    bool bold;
+};
+
+// A set of styles resolved once to the SGR escape sequence that selects
+// each of them. Every sequence starts from a reset, so switching from any
+// style to any other is one sequence, and the monochrome theme's sequences
+// are all empty.
+class Theme {
+private:
+    std::string themeName;
+    std::vector<StyleSpec> specs;           // indexed by Style
+    std::vector<std::string> sequences;     // indexed by Style
+    std::vector<bool> paintsBlank;          // a space in this style is visible
+
+public:
+    Theme(const std::string& name, const std::vector<StyleSpec>& specs);
+
+    static Theme monochrome();
+    static Theme dark();
+    static Theme light();
+    // mono, dark or light; returns false for anything else.
+    static bool byName(const std::string& name, Theme& out);
+
+    const std::string& name() const { return themeName; }
+    const std::string& sequence(Style style) const { return sequences[static_cast<int>(style)]; }
+    const StyleSpec& spec(Style style) const { return specs[static_cast<int>(style)]; }
+    // Spaces in styles that do not paint can join any neighbouring run.
+    bool paints(Style style) const { return paintsBlank[static_cast<int>(style)]; }
+    bool isMonochrome() const { return sequences[0].empty(); }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Small helpers shared by the game and the background writers.
+
+// Writes all of data to fd, retrying short and interrupted writes.
+// Returns false on any other error.
+inline bool writeAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Smallest power of two not below value, 1 for 0; ring buffers index with
+// a mask of one less.
+inline std::size_t roundUpPow2(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+// Appends value in decimal without building a temporary string.
+inline void appendNumber(std::string& out, long long value) {
+    char digits[24];
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+}
+
+// Writes text and a newline to path through path + ".tmp", so readers never
+// see a partial file. Text is any string type, including ArenaString.
+template<typename Text>
+bool replaceFile(const std::string& path, const Text& text, std::string& error) {
+    std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && writeAll(fd, text.data(), text.size()) && writeAll(fd, "\n", 1);
+    if (fd >= 0 && ::close(fd) != 0) ok = false;
+    if (!ok) {
+        error = "cannot write " + tmpPath;
+        return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        error = "cannot replace " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+// Turns a catalog JSON file into a header of constexpr tables for
+// builtinCatalog().
+//
+//   catalog_gen <catalog.json> <output.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../src/catalog.h"
+
+static std::string quote(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+static std::string charLiteral(char c) {
+    if (c == '\'' || c == '\\') return std::string("'\\") + c + "'";
+    return std::string("'") + c + "'";
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: catalog_gen <catalog.json> <output.h>\n";
+        return 2;
+    }
+    Catalog catalog;
+    std::string error;
+    if (!loadCatalog(argv[1], catalog, error)) {
+        std::cerr << "catalog_gen: " << error << "\n";
+        return 1;
+    }
+    // The built-in catalog must fit the game's default 80 columns
+    if (!validateCatalog(catalog, 80, error)) {
+        std::cerr << "catalog_gen: " << argv[1] << ": " << error << "\n";
+        return 1;
+    }
+
+    std::ofstream out(argv[2]);
+    out << "// Generated by tools/catalog_gen from " << argv[1] << ". Do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include <array>\n\n"
+        << "#include \"builtin_catalog.h\"\n\n";
+
+    out << "constexpr std::array<CatalogFruitEntry, " << catalog.fruits.size()
+        << "> CATALOG_FRUITS = {{\n";
+    for (const auto& fruit : catalog.fruits) {
+        out << "    {" << quote(fruit.type) << ", " << charLiteral(fruit.symbol) << "},\n";
+    }
+    out << "}};\n\n";
+
+    out << "constexpr std::array<CatalogBasketEntry, " << catalog.baskets.size()
+        << "> CATALOG_BASKETS = {{\n";
+    for (const auto& basket : catalog.baskets) {
+        out << "    {" << basket.x << ", " << quote(basket.type) << ", "
+            << charLiteral(basket.symbol) << "},\n";
+    }
+    out << "}};\n\n";
+
+    const Tuning& tuning = catalog.tuning;
+    out << "constexpr Tuning CATALOG_TUNING = {" << tuning.tickMs << ", " << tuning.catchPoints
+        << ", " << tuning.missPenalty << "};\n";
+
+    if (!out) {
+        std::cerr << "catalog_gen: cannot write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+// Builds a leaderboard file from the leaderboard of a records file, such
+// as an export of historical scores, streamed with loadRecords so files
+// larger than memory can be imported. Replaces the leaderboard file; the
+// scores it has not merged yet are kept. Run it while the game is closed.
+//
+//   import_records <records.json> <leaderboard.dat>
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "../src/leaderboard.h"
+#include "../src/record_loader.h"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: import_records <records.json> <leaderboard.dat>\n";
+        return 2;
+    }
+    RecordSet records;
+    std::string error;
+    if (!loadRecords(argv[1], records, error)) {
+        std::cerr << "import_records: " << error << "\n";
+        return 1;
+    }
+    std::size_t count = records.leaderboard.size();
+    if (!Leaderboard::build(argv[2], std::move(records.leaderboard), error)) {
+        std::cerr << "import_records: " << error << "\n";
+        return 1;
+    }
+    std::cout << "imported " << count << " scores into " << argv[2] << "\n";
+    return 0;
+}